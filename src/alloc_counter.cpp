@@ -0,0 +1,39 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "config.h"
+#include "alloc_counter.hpp"
+
+static std::atomic<std::uint64_t> allocation_count{0};
+
+namespace alloc_counter {
+#ifdef BUNNY_ALLOC_CHECK
+  bool enabled() { return true; }
+#else
+  bool enabled() { return false; }
+#endif
+
+  std::uint64_t allocations() {
+    return allocation_count.load(std::memory_order_relaxed);
+  }
+}
+
+#ifdef BUNNY_ALLOC_CHECK
+// the nothrow and array forms forward to these in libstdc++ and libc++
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+  if (void* ptr{std::malloc(size ? size : 1)})
+    return ptr;
+
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
\ No newline at end of file
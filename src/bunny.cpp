@@ -4,24 +4,42 @@
 int Bunny::age() const { return _age; }
 const Gender& Bunny::gender() const { return _gender; }
 const BunnyColour& Bunny::colour() const { return _colour; }
-const std::string& Bunny::name() const { return _name; }
+std::string_view Bunny::name() const { return bunny_names[_name]; }
+int Bunny::name_index() const { return _name; }
 bool Bunny::infected() const { return _mutant; }
+int Bunny::hunger() const { return _hunger; }
+std::uint32_t Bunny::id() const { return _id; }
 
-Bunny::Bunny(sf::Vector2i bunny_pos) :
+// a mutant_chance of 0 disables infection at birth
+Bunny::Bunny(sf::Vector2i bunny_pos, int max_age, int mutant_chance) :
   _gender(util::rnd_enum_class<Gender>()),
   _colour(util::rnd_enum_class<BunnyColour>()),
-  _age(util::rnd_range(0, 10)),
-  _name(bunny_names[util::rnd_range(0, bunny_names_size - 1)]),
-  _mutant(util::rnd_range(1, 100) == 1),
+  _age(util::rnd_range(0, max_age)),
+  _name(util::rnd_range(0, bunny_names_size - 1)),
+  _mutant(mutant_chance > 0 && util::rnd_range(1, mutant_chance) == 1),
   pos(bunny_pos)
 {
   
 }
 
-Bunny::Bunny(sf::Vector2i pos, int age, BunnyColour colour) : Bunny(pos) {
+Bunny::Bunny(sf::Vector2i pos, int age, BunnyColour colour,
+  int mutant_chance) : Bunny(pos, 0, mutant_chance)
+{
   _age = age;
   _colour = colour;
 }
 
+// only the name is random, for bunnies drawn from aggregate counts
+Bunny::Bunny(sf::Vector2i pos, int age, BunnyColour colour, Gender gender,
+  bool infected) :
+    _gender(gender),
+    _colour(colour),
+    _age(age),
+    _name(util::rnd_range(0, bunny_names_size - 1)),
+    _mutant(infected),
+    pos(pos) {}
+
 void Bunny::grow(int years) { _age += years; }
-void Bunny::infect() { _mutant = true; }
\ No newline at end of file
+void Bunny::infect() { _mutant = true; }
+void Bunny::feed(bool enough) { _hunger = enough ? 0 : _hunger + 1; }
+void Bunny::set_id(std::uint32_t id) { _id = id; }
\ No newline at end of file
@@ -1,178 +1,284 @@
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdlib>
 
 #include "bunny_manager.hpp"
 #include "tile_map.hpp"
 #include "path_finding.hpp"
+#include "rule_draws.hpp"
 
 using namespace bunny_manager;
-using path_finding::Dir;
-
-static const std::unordered_map<TileType, TileType> bunny_mutant_map {
-  {TileType::white_juvenile, TileType::white_juvenile_mutant},
-  {TileType::white_adult, TileType::white_adult_mutant},
-  {TileType::brown_juvenile, TileType::brown_juvenile_mutant},
-  {TileType::brown_adult, TileType::brown_adult_mutant},
-  {TileType::black_juvenile, TileType::black_juvenile_mutant},
-  {TileType::black_adult, TileType::black_adult_mutant},
-  {TileType::spotted_juvenile, TileType::spotted_juvenile_mutant},
-  {TileType::spotted_adult, TileType::spotted_adult_mutant},
-};
+using rules::rnd_dirs;
 
-static const std::unordered_map<BunnyColour, std::pair<TileType, TileType>> bunny_colour_map {
-  {BunnyColour::white, {TileType::white_juvenile, TileType::white_adult}},
-  {BunnyColour::brown, {TileType::brown_juvenile, TileType::brown_adult}},
-  {BunnyColour::black, {TileType::black_juvenile, TileType::black_adult}},
-  {BunnyColour::spotted, {TileType::spotted_juvenile, TileType::spotted_adult}}
+template<typename Rules>
+static constexpr int mutant_chance{
+  Rules::infection ? Rules::mutant_chance : 0
 };
 
-static std::vector<Dir> rnd_dirs() {
-  std::vector<Dir> dirs{Dir::left, Dir::right, Dir::up, Dir::down};
-  std::random_shuffle(dirs.begin(), dirs.end());
-
-  return dirs;
+bool BunnyFilter::matches(const Bunny& bunny) const {
+  return (!colour || bunny.colour() == *colour) &&
+    (!infected || bunny.infected() == *infected) &&
+    bunny.age() >= min_age && bunny.age() <= max_age;
 }
 
-std::string BunnyManager::bunny_info(const Bunny& bunny) {
-  std::string info{};
+template<typename Rules>
+bool BasicBunnyManager<Rules>::is_starved(const Bunny& bunny) {
+  if constexpr (Rules::food_field)
+    return bunny.hunger() >= Rules::starve_turns;
 
-  info.append(std::to_string(bunny.age()));
-  info.append(" years old, ");
-  info.append(bunny.gender() == Gender::male ? "male" : "female");
-  info.append(", ");
-  info.append(bunny_colour_str[(int)bunny.colour()]);
-
-  return info;
+  return false;
 }
 
-bool BunnyManager::is_overaged(const Bunny& bunny) {
-  return ((bunny.infected() && bunny.age() >= util::rnd_range(7, 10)) ||
-    !bunny.infected() && bunny.age() >= util::rnd_range(10, 12));
+template<typename Rules>
+void BasicBunnyManager<Rules>::emit(EventType type, BunnyHandle handle,
+  const Bunny& bunny, int floor, sf::Vector2i from)
+{
+  TurnEvent event{};
+
+  event.type = type;
+  event.colour = (std::uint8_t)bunny.colour();
+  event.gender = (std::uint8_t)bunny.gender();
+  event.flags = (bunny.infected() ? TurnEvent::infected_flag : 0) |
+    (bunny.age() >= Rules::adult_age ? TurnEvent::adult_flag : 0);
+  event.floor = floor;
+  event.age = bunny.age();
+  event.name = bunny.name_index();
+  event.bunny = handle;
+  event.id = bunny.id();
+  event.pos = bunny.pos;
+  event.from = from;
+
+  _events.events.push_back(event);
 }
 
-void BunnyManager::print_bunny_born(const Bunny& bunny) {
-  if (bunny.infected())
-    _logger.log("Infected "); 
-  
-  std::stringstream output{};
+// steady_clock is read through the vDSO on Linux, so timing the phases
+// adds no syscalls to the turn
+template<typename Rules>
+void BasicBunnyManager<Rules>::lap(std::int64_t& phase) {
+  if (!_timed)
+    return;
 
-  output << "Bunny " << bunny.name() << " was born! ("
-    << bunny_info(bunny) << ")\n";
+  auto now{std::chrono::steady_clock::now()};
 
-  _logger.log(output.str());
-}
+  phase = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    now - _phase_start).count();
 
-void BunnyManager::print_bunny_died(const Bunny& bunny)
-{
-  if (bunny.infected())
-    _logger.log("Infected "); 
+  _phase_start = now;
+}
 
-  std::stringstream output{};
+template<typename Rules>
+void BasicBunnyManager<Rules>::publish() {
+  for (auto consumer : _consumers)
+    consumer->consume(_events);
+}
 
-  output << "Bunny " << bunny.name() << " died! ("
-    << bunny_info(bunny) << ")\n";
+template<typename Rules>
+void BasicBunnyManager<Rules>::spawn_initial(int amount) {
+  if (_walk_map) {
+    int largest{_walk_map->largest_component()};
 
-  _logger.log(output.str());
-}
+    amount = largest == WalkMap::no_component ? 0 :
+      std::min(amount, _walk_map->component_size(largest));
+  }
 
-void BunnyManager::spawn_initial(int amount) {
   for (int i{0}; i < amount; i++) {
     sf::Vector2i pos{};
 
     do {
       pos.x = util::rnd_range(0, _tile_map.width() - 1);
       pos.y = util::rnd_range(0, _tile_map.height() - 1);
-    } while (_bunny_pos_map.contains(pos));
+    } while (occupied(pos) || !spawnable(pos));
+
+    add_bunny(Bunny(pos, Rules::max_initial_age, mutant_chance<Rules>));
+  }
+}
+
+// new bunnies are appended to the iteration order and sorted in with the
+// rest at the end of the turn
+template<typename Rules>
+BunnyHandle BasicBunnyManager<Rules>::add_bunny(const Bunny& bunny,
+  std::uint32_t mother)
+{
+  BunnyHandle handle{_bunnies.create(bunny)};
+
+  _bunnies[handle].set_id(_next_id++);
+  _bunny_pos_map[cell_index(bunny.pos)] = handle;
+  _order.push_back(handle);
+
+  if constexpr (Rules::mate_radius > 0)
+    _index.insert(bunny.pos, handle);
+
+  emit(EventType::born, handle, _bunnies[handle]);
+  _events.events.back().mother = mother;
+
+  return handle;
+}
+
+// callers drop the handle from the iteration order themselves
+template<typename Rules>
+void BasicBunnyManager<Rules>::remove_bunny(BunnyHandle handle,
+  EventType type)
+{
+  const Bunny& bunny{_bunnies[handle]};
+
+  emit(type, handle, bunny, floor_tile_at(bunny.pos));
+  _bunny_pos_map[cell_index(bunny.pos)] = BunnyHandle();
 
-    auto it{_bunnies.insert(_bunnies.end(), Bunny(pos))};
-    _bunny_pos_map.insert({it->pos, *it});
+  if constexpr (Rules::mate_radius > 0)
+    _index.erase(bunny.pos, handle);
 
-    set_bunny_tile(*it);
-    print_bunny_born(*it);
+  _bunnies.destroy(handle);
+}
+
+template<typename Rules>
+bool BasicBunnyManager<Rules>::occupied(sf::Vector2i pos) const {
+  return _tile_map.in_bounds(pos.x, pos.y) &&
+    _bunny_pos_map[cell_index(pos)].valid();
+}
+
+template<typename Rules>
+int BasicBunnyManager<Rules>::cell_index(sf::Vector2i pos) const {
+  return pos.y * _tile_map.width() + pos.x;
+}
+
+template<typename Rules>
+bool BasicBunnyManager<Rules>::walkable(sf::Vector2i pos) const {
+  return _tile_map.in_bounds(pos.x, pos.y) &&
+    (!_walk_map || _walk_map->walkable(pos.x, pos.y));
+}
+
+// initial bunnies only spawn in the largest connected region so they can
+// reach each other
+template<typename Rules>
+bool BasicBunnyManager<Rules>::spawnable(sf::Vector2i pos) const {
+  return !_walk_map ||
+    _walk_map->component(pos.x, pos.y) == _walk_map->largest_component();
+}
+
+template<typename Rules>
+int BasicBunnyManager<Rules>::floor_tile_at(sf::Vector2i pos) const {
+  if constexpr (Rules::food_field) {
+    if (_food_field->food(cell_index(pos)) >= Rules::grass_level)
+      return (int)TileType::grass;
   }
 
-  _logger.log("\n");
+  return (int)_floor_tile;
 }
 
-void BunnyManager::set_bunny_tile(const Bunny& bunny) {
-  auto tile_types{bunny_colour_map.at(bunny.colour())};
-  TileType tile_type{bunny.age() < 2 ? tile_types.first : tile_types.second};
-  
-  if (bunny.infected())
-    tile_type = bunny_mutant_map.at(tile_type);
-  
-  _tile_map.set_tile(bunny.pos.x, bunny.pos.y, (int)tile_type);
+template<typename Rules>
+void BasicBunnyManager<Rules>::move_bunny(BunnyHandle handle,
+  sf::Vector2i new_pos)
+{
+  Bunny& bunny{_bunnies[handle]};
+  sf::Vector2i from{bunny.pos};
+
+  _bunny_pos_map[cell_index(from)] = BunnyHandle();
+
+  if constexpr (Rules::mate_radius > 0)
+    _index.move(from, new_pos, handle);
+
+  bunny.pos = new_pos;
+
+  _bunny_pos_map[cell_index(bunny.pos)] = handle;
+  emit(EventType::moved, handle, bunny, floor_tile_at(from), from);
 }
 
-void BunnyManager::move_bunny_adj(Bunny& bunny) {
+template<typename Rules>
+void BasicBunnyManager<Rules>::move_bunny_adj(BunnyHandle handle) {
+  const Bunny& bunny{_bunnies[handle]};
+
   for (const auto dir : rnd_dirs()) { // move each bunny
-    std::pair<int, int> adj_pos{
-      path_finding::traverse({bunny.pos.x, bunny.pos.y}, dir)
-    };
-    
-    sf::Vector2i new_pos(adj_pos.first, adj_pos.second);
+    sf::Vector2i new_pos{path_finding::traverse(bunny.pos, dir)};
 
-    if (!_tile_map.in_bounds(new_pos.x, new_pos.y))
+    if (!walkable(new_pos))
       continue;
 
-    if (!_bunny_pos_map.contains(new_pos)) {
-      _tile_map.set_tile(bunny.pos.x, bunny.pos.y, (int)_floor_tile);
-      _bunny_pos_map.erase(bunny.pos);
-
-      bunny.pos = new_pos;
-
-      _bunny_pos_map.insert({bunny.pos, bunny});
-      set_bunny_tile(bunny);
+    if (!occupied(new_pos)) {
+      move_bunny(handle, new_pos);
       
       break;
     }
   }
 }
 
-void BunnyManager::mutate_adj(sf::Vector2i pos) {
-  for (const auto dir : rnd_dirs()) {
-    std::pair<int, int> adj_pos_pair{
-      path_finding::traverse({pos.x, pos.y}, dir)
-    };
+// steps down the mate distance field built at the end of the last turn
+template<typename Rules>
+bool BasicBunnyManager<Rules>::seek_mate(BunnyHandle handle) {
+  const int width{_tile_map.width()};
+
+  int cell{_mate_field.descend(cell_index(_bunnies[handle].pos),
+    [this](int adj) { return !_bunny_pos_map[adj].valid(); }
+  )};
+
+  if (cell == path_finding::no_cell)
+    return false;
 
-    sf::Vector2i adj_pos(adj_pos_pair.first, adj_pos_pair.second);
+  move_bunny(handle, sf::Vector2i(cell % width, cell / width));
 
-    if (_bunny_pos_map.contains(adj_pos)) {
-      Bunny& bunny{_bunny_pos_map.at(adj_pos)};
+  return true;
+}
+
+template<typename Rules>
+void BasicBunnyManager<Rules>::mutate_adj(sf::Vector2i pos) {
+  for (const auto dir : rnd_dirs()) {
+    sf::Vector2i adj_pos{path_finding::traverse(pos, dir)};
+
+    if (occupied(adj_pos)) {
+      BunnyHandle handle{_bunny_pos_map[cell_index(adj_pos)]};
+      Bunny& bunny{_bunnies[handle]};
 
       if (bunny.infected())
         continue;
 
       bunny.infect();
-      set_bunny_tile(bunny);
+      emit(EventType::infected, handle, bunny);
 
       break;
     }
   }
 }
 
-void BunnyManager::birth_bunnies(breedable_females_t& breedable_females) {
-  for (const auto& female : breedable_females) {
-    sf::Vector2i pos{female.first};
+template<typename Rules>
+bool BasicBunnyManager<Rules>::has_mate_near(sf::Vector2i pos) const {
+  return _index.any_in_radius(pos, Rules::mate_radius,
+    [this](const auto& entry) {
+      const Bunny& bunny{_bunnies[entry.item]};
 
-    for (const auto dir : rnd_dirs()) {
-      std::pair<int, int> adj_pos{path_finding::traverse({pos.x, pos.y}, dir)};
-      sf::Vector2i new_pos(adj_pos.first, adj_pos.second);
+      return bunny.gender() == Gender::male && !bunny.infected() &&
+        bunny.age() >= Rules::adult_age;
+    }
+  );
+}
+
+template<typename Rules>
+void BasicBunnyManager<Rules>::birth_bunnies(breedable_females_t& breedable_females) {
+  for (const auto female : breedable_females) {
+    // copied as creating a bunny may move the pool's records
+    sf::Vector2i pos{_bunnies[female].pos};
+    BunnyColour colour{_bunnies[female].colour()};
+    std::uint32_t mother{_bunnies[female].id()};
 
-      if (!_tile_map.in_bounds(new_pos.x, new_pos.y))
+    if constexpr (Rules::mate_radius > 0) {
+      if (!has_mate_near(pos))
         continue;
+    }
 
-      if (!_bunny_pos_map.contains(new_pos)) {
-        auto it{
-          _bunnies.insert(_bunnies.end(), Bunny(new_pos, 0, female.second))
-        };
+    for (const auto dir : rnd_dirs()) {
+      sf::Vector2i new_pos{path_finding::traverse(pos, dir)};
 
-        _bunny_pos_map.insert({it->pos, *it});
+      if (!walkable(new_pos))
+        continue;
 
-        set_bunny_tile(*it);
-        print_bunny_born(*it);
+      if (!occupied(new_pos)) {
+        BunnyHandle handle{
+          add_bunny(Bunny(new_pos, 0, colour, mutant_chance<Rules>), mother)
+        };
 
-        if (it->infected())
-          mutate_adj(it->pos);
+        if constexpr (Rules::infection) {
+          if (_bunnies[handle].infected())
+            mutate_adj(new_pos);
+        }
 
         break;
       }
@@ -180,129 +286,529 @@ void BunnyManager::birth_bunnies(breedable_females_t& breedable_females) {
   }
 }
 
-void BunnyManager::sort_by_age() {
-  _bunnies.sort(
-    [](const Bunny& b1, const Bunny& b2) {
-      return b1.age() < b2.age();
-    }
-  );
+// stable counting sort of the order into sorted; ages are small so this is
+// linear and reuses its buffers every turn
+template<typename Rules>
+void BasicBunnyManager<Rules>::sort_by_age(std::vector<BunnyHandle>& sorted) {
+  int max_age{0};
+
+  for (const auto handle : _order)
+    max_age = std::max(max_age, _bunnies[handle].age());
+
+  _age_counts.assign(max_age + 2, 0);
+
+  for (const auto handle : _order)
+    _age_counts[_bunnies[handle].age() + 1]++;
+
+  for (int age{1}; age < (int)_age_counts.size(); age++)
+    _age_counts[age] += _age_counts[age - 1];
+
+  sorted.resize(_order.size());
+
+  for (const auto handle : _order)
+    sorted[_age_counts[_bunnies[handle].age()]++] = handle;
 }
 
-void BunnyManager::food_shortage() {
-  _logger.log("Food shortage occured!\n");
-  _cull_bunnies.resize(_bunnies.size());
+// Bunnies next to each other on the map are then updated one after another,
+// so the cells, tiles and neighbours each one touches are mostly still in
+// cache from the last. Positions are unique so the keys never tie.
+template<typename Rules>
+void BasicBunnyManager<Rules>::sort_spatially() {
+  _spatial_keys.clear();
+
+  for (std::size_t i{0}; i < _order.size(); i++) {
+    const sf::Vector2i pos{_bunnies[_order[i]].pos};
+
+    _spatial_keys.push_back(
+      (std::uint64_t)util::hilbert_index(_hilbert_side, pos.x, pos.y) << 32 |
+      i);
+  }
+
+  std::sort(_spatial_keys.begin(), _spatial_keys.end());
+  _order_scratch.resize(_order.size());
+
+  for (std::size_t i{0}; i < _order.size(); i++)
+    _order_scratch[i] = _order[_spatial_keys[i] & 0xffffffffu];
+
+  _order.swap(_order_scratch);
+}
+
+template<typename Rules>
+void BasicBunnyManager<Rules>::cull_randomly(int keep) {
+  _cull_bunnies.resize(_order.size());
   
   std::fill(
     _cull_bunnies.begin(),
-    _cull_bunnies.begin() + (bunny_limit / 2), 
+    _cull_bunnies.begin() + keep, 
     false
   );
 
   std::fill(
-    _cull_bunnies.begin() + (bunny_limit / 2),
+    _cull_bunnies.begin() + keep,
     _cull_bunnies.end(), 
     true
   );
 
-  static std::random_device dev{};
-  auto rng = std::default_random_engine{dev()};
-
-  std::shuffle(_cull_bunnies.begin(), _cull_bunnies.end(), rng);
+  std::shuffle(_cull_bunnies.begin(), _cull_bunnies.end(), util::rng());
   
-  int i{0};
+  std::size_t kept{0};
 
-  // cull half at random
-  for (auto it{_bunnies.begin()}; it != _bunnies.end(); i++) {
-    if (_cull_bunnies.at(i)) {
-      _tile_map.set_tile(it->pos.x, it->pos.y, (int)_floor_tile);
-      _bunny_pos_map.erase(it->pos);
-
-      it = _bunnies.erase(it);
-    }
+  for (std::size_t i{0}; i < _order.size(); i++) {
+    if (_cull_bunnies[i])
+      remove_bunny(_order[i], EventType::culled);
 
     else
-      it++;
+      _order[kept++] = _order[i];
   }
+
+  _order.resize(kept);
 }
 
-BunnyManager::BunnyManager(TileMap& tile_map, TileType floor_tile,
-  Logger& logger) :
+// cull half at random
+template<typename Rules>
+void BasicBunnyManager<Rules>::food_shortage() {
+  _events.events.push_back({EventType::shortage});
+  cull_randomly(Rules::bunny_limit / 2);
+}
+
+template<typename Rules>
+BasicBunnyManager<Rules>::BasicBunnyManager(TileMap& tile_map,
+  TileType floor_tile, std::vector<EventConsumer*> consumers,
+  const WalkMap* walk_map) :
     _tile_map(tile_map),
     _floor_tile(floor_tile),
-    _logger(logger),
-    _cull_bunnies(bunny_limit)
+    _consumers(std::move(consumers)),
+    _walk_map(walk_map),
+    _cull_bunnies(Rules::bunny_limit)
+{
+  _bunny_pos_map.resize(_tile_map.width() * _tile_map.height());
+
+  // The cull keeps the population under twice the limit (every female
+  // breeding in one turn), so sizing for that up front means the peak
+  // turns late in a run do not grow the buffers.
+  static_assert(!(Rules::food_field && Rules::food_shortage),
+    "the food field replaces the food shortage cull");
+  static_assert(Rules::forage_range == 0 || Rules::food_field,
+    "foraging walks towards food in the food field");
+
+  if constexpr (Rules::food_shortage) {
+    const int peak{Rules::bunny_limit * 2};
+
+    _bunnies.reserve(peak);
+    _order.reserve(peak);
+    _order_scratch.reserve(peak);
+    _breedable_females.reserve(peak);
+    _mate_sources.reserve(peak);
+    _cull_bunnies.reserve(peak);
+
+    if constexpr (Rules::spatial_order > 0)
+      _spatial_keys.reserve(peak);
+
+    // a move, infection and death or birth each plus the roster
+    _events.events.reserve(peak * 4);
+  }
+
+  _age_counts.reserve(Rules::max_lifespan + 2);
+
+  while (_hilbert_side < std::max(_tile_map.width(), _tile_map.height()))
+    _hilbert_side *= 2;
+
+  if constexpr (Rules::mate_radius > 0) {
+    _index = SpatialIndex<BunnyHandle>(_tile_map.width(), _tile_map.height(),
+      Rules::index_bucket_size);
+
+    // one bunny per cell bounds a bucket, so this is the most it can hold
+    _index.reserve(Rules::index_bucket_size * Rules::index_bucket_size);
+  }
+
+  if constexpr (Rules::seek_mates)
+    _mate_field.resize(_tile_map.width(), _tile_map.height());
+
+  // a route never leaves the forage window
+  if constexpr (Rules::forage_range > 0) {
+    const int side{2 * Rules::forage_range + 1};
+
+    _route.reserve(side * side);
+  }
+
+  if constexpr (Rules::food_field) {
+    _food_field = std::make_unique<FoodField>(_tile_map.width(),
+      _tile_map.height(), Rules::food_regrow, Rules::food_threads, walk_map);
+  }
+
+  for (const auto consumer : _consumers) {
+    _roster = _roster || consumer->wants_roster();
+    _timed = _timed || consumer->wants_timings();
+  }
+
+  _events.clear(0);
+  spawn_initial(Rules::initial_spawn);
+  publish();
+}
+
+template<typename Rules>
+int BasicBunnyManager<Rules>::turn() const { return _turn; }
+
+template<typename Rules>
+void BasicBunnyManager<Rules>::add_consumer(EventConsumer& consumer) {
+  _consumers.push_back(&consumer);
+  _roster = _roster || consumer.wants_roster();
+  _timed = _timed || consumer.wants_timings();
+}
+
+template<typename Rules>
+const FoodField* BasicBunnyManager<Rules>::food_field() const {
+  return _food_field.get();
+}
+
+template<typename Rules>
+const BunnyPool& BasicBunnyManager<Rules>::bunnies() const { return _bunnies; }
+
+template<typename Rules>
+const std::vector<BunnyHandle>& BasicBunnyManager<Rules>::order() const {
+  return _order;
+}
+
+template<typename Rules>
+const SpatialIndex<BunnyHandle>& BasicBunnyManager<Rules>::index() const {
+  return _index;
+}
+
+template<typename Rules>
+BunnyHandle BasicBunnyManager<Rules>::bunny_at(sf::Vector2i pos) const {
+  return _tile_map.in_bounds(pos.x, pos.y) ?
+    _bunny_pos_map[cell_index(pos)] : BunnyHandle();
+}
+
+// Small rectangles are read off the position map, larger ones from the
+// index buckets they overlap, which come in no order so are sorted by row.
+template<typename Rules>
+void BasicBunnyManager<Rules>::bunnies_in(sf::IntRect rect,
+  const BunnyFilter& filter, std::vector<BunnyHandle>& found) const
 {
-  spawn_initial(5);
+  found.clear();
+
+  const int left{std::max(rect.left, 0)};
+  const int top{std::max(rect.top, 0)};
+  const int right{std::min(rect.left + rect.width, _tile_map.width())};
+  const int bottom{std::min(rect.top + rect.height, _tile_map.height())};
+
+  if (left >= right || top >= bottom)
+    return;
+
+  auto add = [&](BunnyHandle handle) {
+    if (filter.matches(_bunnies[handle]))
+      found.push_back(handle);
+  };
+
+  const int area{(right - left) * (bottom - top)};
+
+  if constexpr (Rules::mate_radius > 0) {
+    if (area > Rules::index_bucket_size * Rules::index_bucket_size) {
+      _index.for_each_in_rect(sf::IntRect(left, top, right - left,
+        bottom - top), [&](const auto& entry) { add(entry.item); });
+
+      std::sort(found.begin(), found.end(), [this](auto a, auto b) {
+        const sf::Vector2i& pa{_bunnies[a].pos};
+        const sf::Vector2i& pb{_bunnies[b].pos};
+
+        return pa.y < pb.y || (pa.y == pb.y && pa.x < pb.x);
+      });
+
+      return;
+    }
+  }
+
+  for (int y{top}; y < bottom; y++) {
+    for (int x{left}; x < right; x++) {
+      const BunnyHandle handle{_bunny_pos_map[cell_index({x, y})]};
+
+      if (handle.valid())
+        add(handle);
+    }
+  }
+}
+
+template<typename Rules>
+void BasicBunnyManager<Rules>::report_memory(MemoryReport& report) const {
+  report.add("bunny pool", _bunnies.memory_bytes());
+  report.add("position map", memory_usage::bytes(_bunny_pos_map));
+
+  report.add("turn buffers", memory_usage::bytes(_order) +
+    memory_usage::bytes(_order_scratch) + memory_usage::bytes(_spatial_keys) +
+    memory_usage::bytes(_age_counts) + memory_usage::bytes(_breedable_females) +
+    memory_usage::bytes(_mate_sources) + memory_usage::bytes(_route) +
+    _cull_bunnies.capacity() / CHAR_BIT);
+
+  report.add("events", memory_usage::bytes(_events.events));
+
+  if constexpr (Rules::seek_mates)
+    report.add("mate field", _mate_field.memory_bytes());
+
+  if constexpr (Rules::food_field)
+    report.add("food field", _food_field->memory_bytes());
+
+  if constexpr (Rules::mate_radius > 0)
+    report.add("spatial index", _index.memory_bytes());
+}
+
+template<typename Rules>
+void BasicBunnyManager<Rules>::cull(int keep) {
+  if (keep >= (int)_order.size())
+    return;
+
+  _events.clear(_turn);
+  cull_randomly(std::max(keep, 0));
+  publish();
+}
+
+// the events were published so nothing reads them any more
+template<typename Rules>
+void BasicBunnyManager<Rules>::compact() {
+  _bunnies.compact();
+  _order.shrink_to_fit();
+  _order_scratch.clear();
+  _order_scratch.shrink_to_fit();
+  _spatial_keys.clear();
+  _spatial_keys.shrink_to_fit();
+  _breedable_females.clear();
+  _breedable_females.shrink_to_fit();
+  _mate_sources.clear();
+  _mate_sources.shrink_to_fit();
+  _cull_bunnies.clear();
+  _cull_bunnies.shrink_to_fit();
+  _events.events.clear();
+  _events.events.shrink_to_fit();
+  _index.compact();
+}
+
+// takes the first step of an A* route to the cell with the most food within
+// forage_range, preferring the nearest on ties; the route stays inside that
+// window so an unreachable target never searches the whole map
+template<typename Rules>
+bool BasicBunnyManager<Rules>::forage(BunnyHandle handle) {
+  const int width{_tile_map.width()};
+  const int height{_tile_map.height()};
+  const sf::Vector2i pos{_bunnies[handle].pos};
+  const int left{std::max(pos.x - Rules::forage_range, 0)};
+  const int right{std::min(pos.x + Rules::forage_range, width - 1)};
+  const int top{std::max(pos.y - Rules::forage_range, 0)};
+  const int bottom{std::min(pos.y + Rules::forage_range, height - 1)};
+
+  int target{cell_index(pos)};
+  int target_food{_food_field->food(target)};
+  int target_dist{0};
+
+  for (int r{top}; r <= bottom; r++) {
+    for (int c{left}; c <= right; c++) {
+      int cell{r * width + c};
+      int food{_food_field->food(cell)};
+      int dist{std::abs(c - pos.x) + std::abs(r - pos.y)};
+
+      if (food < target_food || (food == target_food && dist >= target_dist))
+        continue;
+
+      if (_bunny_pos_map[cell].valid() ||
+        (_walk_map && !_walk_map->walkable(cell)))
+      {
+        continue;
+      }
+
+      target = cell;
+      target_food = food;
+      target_dist = dist;
+    }
+  }
+
+  if (target == cell_index(pos))
+    return false;
+
+  bool found{path_finding::a_star(width, height, cell_index(pos), target,
+    [&](int cell) {
+      int c{cell % width};
+      int r{cell / width};
+
+      return c >= left && c <= right && r >= top && r <= bottom &&
+        (!_walk_map || _walk_map->walkable(cell));
+    }, _route
+  )};
+
+  if (!found || _bunny_pos_map[_route[1]].valid())
+    return false;
+
+  move_bunny(handle, sf::Vector2i(_route[1] % width, _route[1] / width));
+
+  return true;
 }
 
-bool BunnyManager::next_turn() {
+template<typename Rules>
+bool BasicBunnyManager<Rules>::next_turn() {
   if (_bunnies.empty())
     return true;
 
+  _events.clear(++_turn);
+
+  if (_timed)
+    _phase_start = std::chrono::steady_clock::now();
+
+  if constexpr (Rules::food_field)
+    _food_field->update();
+
+  lap(_events.timings.food);
+
   int breedable_male_count{0};
-  breedable_females_t breedable_females{};
+  std::size_t kept{0};
 
-  for(auto it{_bunnies.begin()}; it != _bunnies.end();) {
-    Bunny& bunny{*it};
+  _breedable_females.clear();
 
-    // kill over-aged bunnies
-    if (is_overaged(bunny)) {
-      _tile_map.set_tile(bunny.pos.x, bunny.pos.y, (int)_floor_tile);
-      print_bunny_died(bunny);
-      _bunny_pos_map.erase(it->pos);
-      it = _bunnies.erase(it);
+  // survivors are compacted to the front of the order as it is walked
+  for (std::size_t i{0}; i < _order.size(); i++) {
+    BunnyHandle handle{_order[i]};
+    Bunny& bunny{_bunnies[handle]};
+
+    // kill over-aged and starved bunnies
+    bool overaged{rules::is_overaged<Rules>(bunny)};
+
+    if (overaged || is_starved(bunny)) {
+      remove_bunny(handle, EventType::died);
+
+      if (!overaged)
+        _events.events.back().flags |= TurnEvent::starved_flag;
 
       continue;
     }
     
-    move_bunny_adj(bunny);
+    if constexpr (Rules::movement) {
+      bool seeking{false};
+
+      if constexpr (Rules::seek_mates) {
+        seeking = bunny.gender() == Gender::female && !bunny.infected() &&
+          bunny.age() >= Rules::adult_age && seek_mate(handle);
+      }
+
+      if constexpr (Rules::forage_range > 0) {
+        seeking = seeking || (_food_field->food(cell_index(bunny.pos)) <
+          Rules::food_need && forage(handle));
+      }
+
+      if (!seeking)
+        move_bunny_adj(handle);
+    }
+
+    if constexpr (Rules::infection) {
+      if (bunny.infected())
+        mutate_adj(bunny.pos);
+    }
 
-    if (bunny.infected())
-      mutate_adj(bunny.pos);
+    if constexpr (Rules::food_field) {
+      int eaten{_food_field->consume(cell_index(bunny.pos), Rules::food_need)};
+
+      bunny.feed(eaten >= Rules::food_need);
+    }
 
     bunny.grow(1);
 
-    if (!bunny.infected() && bunny.age() >= 2) {
-      if (bunny.gender() == Gender::male)
+    if (!bunny.infected() && bunny.age() >= Rules::adult_age) {
+      if (bunny.gender() == Gender::male) {
         breedable_male_count += 1;
+
+        if constexpr (Rules::seek_mates)
+          _mate_sources.push_back(cell_index(bunny.pos));
+      }
       
       else
-        breedable_females.push_back({bunny.pos, bunny.colour()});
+        _breedable_females.push_back(handle);
     }
 
-    ++it;
+    _order[kept++] = handle;
   }
 
+  _order.resize(kept);
+  lap(_events.timings.update);
+
   if (breedable_male_count)
-    birth_bunnies(breedable_females);
+    birth_bunnies(_breedable_females);
+
+  lap(_events.timings.births);
 
-  sort_by_age();
+  if constexpr (Rules::seek_mates) {
+    _mate_field.build(_mate_sources,
+      [this](int cell) { return !_walk_map || _walk_map->walkable(cell); },
+      Rules::seek_range);
+    _mate_sources.clear();
+  }
 
-  _logger.log("\nBunnies remaining: \n");
+  // in spatial order the age order is only built for the roster
+  if constexpr (Rules::spatial_order > 0) {
+    if (_turn % Rules::spatial_order == 0)
+      sort_spatially();
 
-  for (const auto& bunny : _bunnies) {
-    if (bunny.infected())
-      _logger.log("Infected ");
+    if (_roster)
+      sort_by_age(_order_scratch);
+  }
 
-    std::stringstream output{};
-    
-    output << "Bunny " << bunny.name() << " (" << bunny_info(bunny) <<
-      ") at (" << bunny.pos.x << ", " << bunny.pos.y << ")\n";
+  else {
+    sort_by_age(_order_scratch);
+    _order.swap(_order_scratch);
+  }
+
+  lap(_events.timings.sort);
+
+  if (_roster) {
+    const auto& by_age{Rules::spatial_order > 0 ? _order_scratch : _order};
 
-    _logger.log(output.str());
+    _events.events.push_back({EventType::roster_begin});
+
+    for (const auto handle : by_age)
+      emit(EventType::remaining, handle, _bunnies[handle]);
+
+    _events.events.push_back({EventType::roster_end});
   }
 
-  _logger.log("\n");
+  if constexpr (Rules::food_shortage) {
+    if (_bunnies.size() > Rules::bunny_limit)
+      food_shortage();
+  }
 
-  if (_bunnies.size() > bunny_limit)
-    food_shortage();
+  lap(_events.timings.shortage);
+  publish();
 
   return false;
 }
 
-void BunnyManager::reset() {
+template<typename Rules>
+void BasicBunnyManager<Rules>::reset() {
+  // only bunny tiles are cleared so generated terrain survives a reset
+  _turn = 0;
+  _events.clear(0);
+
+  for (const auto handle : _order) {
+    const Bunny& bunny{_bunnies[handle]};
+
+    emit(EventType::removed, handle, bunny, floor_tile_at(bunny.pos));
+    _bunny_pos_map[cell_index(bunny.pos)] = BunnyHandle();
+  }
+
+  if constexpr (Rules::food_field)
+    _food_field->fill(FoodField::max_food);
+
   _bunnies.clear();
-  _bunny_pos_map.clear();
-  _tile_map.clear((int)_floor_tile);
-  spawn_initial(5);
-}
\ No newline at end of file
+  _order.clear();
+  _index.clear();
+
+  if constexpr (Rules::seek_mates)
+    _mate_field.build(_mate_sources, [](int) { return true; });
+
+  spawn_initial(Rules::initial_spawn);
+  publish();
+}
+
+template class BasicBunnyManager<rules::Classic>;
+template class BasicBunnyManager<rules::Default>;
+template class BasicBunnyManager<rules::Seeking>;
+template class BasicBunnyManager<rules::NoInfection>;
+template class BasicBunnyManager<rules::NoMovement>;
+template class BasicBunnyManager<rules::Unlimited>;
+template class BasicBunnyManager<rules::Grazing>;
+template class BasicBunnyManager<rules::Crowded>;
+template class BasicBunnyManager<rules::Local>;
\ No newline at end of file
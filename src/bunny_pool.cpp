@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "bunny_pool.hpp"
+#include "memory_usage.hpp"
+
+int BunnyPool::size() const { return _size; }
+int BunnyPool::capacity() const { return _slots.size(); }
+bool BunnyPool::empty() const { return _size == 0; }
+
+std::size_t BunnyPool::memory_bytes() const {
+  return memory_usage::bytes(_slots) + memory_usage::bytes(_generations) +
+    memory_usage::bytes(_free);
+}
+
+void BunnyPool::reserve(int count) {
+  _slots.reserve(count);
+  _generations.reserve(count);
+  _free.reserve(count);
+}
+
+BunnyHandle BunnyPool::create(const Bunny& bunny) {
+  std::uint32_t index{};
+
+  if (!_free.empty()) {
+    index = _free.back();
+    _free.pop_back();
+    _slots[index] = bunny;
+  }
+
+  // slots given back by compact still have their generation
+  else {
+    index = _slots.size();
+
+    if (index >= max_slots)
+      throw std::length_error("bunny pool is out of handle indices");
+
+    _slots.push_back(bunny);
+
+    if (index == _generations.size())
+      _generations.push_back(0);
+  }
+
+  _size++;
+
+  return BunnyHandle(index, _generations[index]);
+}
+
+void BunnyPool::destroy(BunnyHandle handle) {
+  if (!alive(handle))
+    return;
+
+  std::uint32_t index{handle.index()};
+
+  _generations[index] =
+    (_generations[index] + 1) & BunnyHandle::generation_mask;
+  _free.push_back(index);
+  _size--;
+}
+
+// slots stay allocated for reuse; bumping every generation invalidates
+// handles that outlive the clear
+void BunnyPool::clear() {
+  _free.clear();
+
+  for (std::uint32_t index{0}; index < _slots.size(); index++) {
+    _generations[index] =
+      (_generations[index] + 1) & BunnyHandle::generation_mask;
+    _free.push_back(_slots.size() - 1 - index);
+  }
+
+  _size = 0;
+}
+
+// Generations of the dropped slots are kept, so handles issued for them
+// still read as dead when the slab grows over them again.
+void BunnyPool::compact() {
+  std::vector<bool> free(_slots.size());
+
+  for (const auto index : _free)
+    free[index] = true;
+
+  std::size_t end{_slots.size()};
+
+  while (end > 0 && free[end - 1])
+    end--;
+
+  _free.erase(std::remove_if(_free.begin(), _free.end(),
+    [end](std::uint32_t index) { return index >= end; }), _free.end());
+
+  _slots.erase(_slots.begin() + end, _slots.end());
+  _slots.shrink_to_fit();
+  _free.shrink_to_fit();
+}
\ No newline at end of file
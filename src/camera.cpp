@@ -0,0 +1,63 @@
+#include <algorithm>
+
+#include "camera.hpp"
+
+Camera::Camera(sf::Vector2i world, sf::Vector2i screen) :
+  _world(world), _screen(screen)
+{
+  fit();
+}
+
+sf::Vector2i Camera::screen() const { return _screen; }
+sf::Vector2f Camera::centre() const { return _centre; }
+float Camera::zoom() const { return _zoom; }
+
+// the centre stays on the map so it can not be panned out of view
+void Camera::clamp() {
+  _zoom = std::clamp(_zoom, min_zoom, max_zoom);
+  _centre.x = std::clamp(_centre.x, 0.0f, (float)_world.x);
+  _centre.y = std::clamp(_centre.y, 0.0f, (float)_world.y);
+}
+
+void Camera::resize(sf::Vector2i screen) {
+  _screen = screen;
+  clamp();
+}
+
+void Camera::fit() {
+  _centre = sf::Vector2f(_world.x / 2.0f, _world.y / 2.0f);
+  _zoom = std::min((float)_screen.x / _world.x, (float)_screen.y / _world.y);
+  clamp();
+}
+
+void Camera::pan(sf::Vector2f screen_delta) {
+  _centre.x += screen_delta.x / _zoom;
+  _centre.y += screen_delta.y / _zoom;
+  clamp();
+}
+
+void Camera::zoom_at(sf::Vector2i screen_pos, float factor) {
+  sf::Vector2f before{to_world(sf::Vector2f(screen_pos))};
+
+  _zoom = std::clamp(_zoom * factor, min_zoom, max_zoom);
+
+  sf::Vector2f after{to_world(sf::Vector2f(screen_pos))};
+
+  _centre.x += before.x - after.x;
+  _centre.y += before.y - after.y;
+  clamp();
+}
+
+sf::Vector2f Camera::to_world(sf::Vector2f screen_pos) const {
+  return sf::Vector2f(
+    _centre.x + (screen_pos.x - _screen.x / 2.0f) / _zoom,
+    _centre.y + (screen_pos.y - _screen.y / 2.0f) / _zoom
+  );
+}
+
+sf::FloatRect Camera::visible() const {
+  sf::Vector2f top_left{to_world(sf::Vector2f(0, 0))};
+
+  return sf::FloatRect(top_left.x, top_left.y, _screen.x / _zoom,
+    _screen.y / _zoom);
+}
\ No newline at end of file
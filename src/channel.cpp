@@ -0,0 +1,262 @@
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+
+#include "channel.hpp"
+
+static const int spins_before_yield{1024};
+static const int socket_poll_ms{100};
+
+// True once peer has exited. Checking any_child reaps the child, so that
+// it is remembered for every later wait on other channels.
+static bool has_exited(int peer) {
+  static bool child_exited{false};
+
+  if (peer == Channel::any_child) {
+    child_exited = child_exited || waitpid(-1, nullptr, WNOHANG) > 0;
+
+    return child_exited;
+  }
+
+  return peer > 0 && kill(peer, 0) != 0 && errno == ESRCH;
+}
+
+// Spins, then yields. Once yielding, gone is checked every
+// spins_before_yield rounds as it may make a syscall; false if it gave up.
+template<typename Ready, typename Gone>
+static bool wait_until(Ready ready, Gone gone) {
+  for (int i{0}; !ready(); i++) {
+    if (i < spins_before_yield)
+      continue;
+
+    std::this_thread::yield();
+
+    if (i % spins_before_yield == 0 && gone())
+      return false;
+  }
+
+  return true;
+}
+
+std::size_t ShmRing::round_capacity(std::size_t capacity) {
+  return std::bit_ceil(std::max<std::size_t>(capacity, 64));
+}
+
+std::size_t ShmRing::bytes_needed(std::size_t capacity) {
+  return sizeof(Header) + round_capacity(capacity);
+}
+
+// the memory is zeroed by the mapping, which is a valid empty header
+ShmRing::ShmRing(void* memory, std::size_t capacity) :
+  _header(static_cast<Header*>(memory)),
+  _data(static_cast<std::uint8_t*>(memory) + sizeof(Header)),
+  _capacity(round_capacity(capacity)) {}
+
+bool ShmRing::write(const void* data, std::size_t size, int peer) {
+  const auto* bytes{static_cast<const std::uint8_t*>(data)};
+  std::uint64_t head{_header->head.load(std::memory_order_relaxed)};
+
+  auto gone = [&]() {
+    return _header->closed.load(std::memory_order_acquire) ||
+      has_exited(peer);
+  };
+
+  while (size) {
+    std::uint64_t tail{};
+
+    bool ready{wait_until([&]() {
+      tail = _header->tail.load(std::memory_order_acquire);
+
+      return head - tail < _capacity;
+    }, gone)};
+
+    if (!ready)
+      return false;
+
+    // copies up to the free space and the end of the buffer
+    std::size_t offset(head & (_capacity - 1));
+    std::size_t count{std::min({size, _capacity - (head - tail),
+      _capacity - offset})};
+
+    std::memcpy(_data + offset, bytes, count);
+    head += count;
+    bytes += count;
+    size -= count;
+    _header->head.store(head, std::memory_order_release);
+  }
+
+  return true;
+}
+
+// bytes written before the writer closed are still read
+bool ShmRing::read(void* data, std::size_t size, int peer) {
+  auto* bytes{static_cast<std::uint8_t*>(data)};
+  std::uint64_t tail{_header->tail.load(std::memory_order_relaxed)};
+
+  auto gone = [&]() {
+    return _header->closed.load(std::memory_order_acquire) ||
+      has_exited(peer);
+  };
+
+  while (size) {
+    std::uint64_t head{};
+
+    bool ready{wait_until([&]() {
+      head = _header->head.load(std::memory_order_acquire);
+
+      return head != tail;
+    }, gone)};
+
+    if (!ready)
+      return false;
+
+    std::size_t offset(tail & (_capacity - 1));
+    std::size_t count{std::min({size, std::size_t(head - tail),
+      _capacity - offset})};
+
+    std::memcpy(bytes, _data + offset, count);
+    tail += count;
+    bytes += count;
+    size -= count;
+    _header->tail.store(tail, std::memory_order_release);
+  }
+
+  return true;
+}
+
+void ShmRing::close() {
+  _header->closed.store(1, std::memory_order_release);
+}
+
+RingChannel::RingChannel(ShmRing out, ShmRing in) : _out(out), _in(in) {}
+
+void RingChannel::send(const void* data, std::size_t size) {
+  if (!_failed)
+    _failed = !_out.write(data, size, _peer);
+}
+
+void RingChannel::receive(void* data, std::size_t size) {
+  if (_failed || !_in.read(data, size, _peer)) {
+    _failed = true;
+    std::memset(data, 0, size);
+  }
+}
+
+void RingChannel::close() {
+  _out.close();
+  _in.close();
+}
+
+SocketChannel::SocketChannel(int fd) : _fd(fd) {}
+
+SocketChannel::~SocketChannel() {
+  if (_fd >= 0)
+    ::close(_fd);
+}
+
+void SocketChannel::send(const void* data, std::size_t size) {
+  const auto* bytes{static_cast<const std::uint8_t*>(data)};
+
+  while (size && !_failed) {
+    ssize_t sent{::send(_fd, bytes, size, MSG_NOSIGNAL)};
+
+    if (sent < 0 && errno == EINTR)
+      continue;
+
+    if (sent <= 0) {
+      _failed = true;
+
+      return;
+    }
+
+    bytes += sent;
+    size -= sent;
+  }
+}
+
+// Every forked process holds a copy of every socket, so a peer that dies
+// does not always end the stream; the watched process is checked whenever
+// a poll times out.
+void SocketChannel::receive(void* data, std::size_t size) {
+  auto* bytes{static_cast<std::uint8_t*>(data)};
+
+  while (size && !_failed) {
+    pollfd fd{_fd, POLLIN, 0};
+    int polled{poll(&fd, 1, socket_poll_ms)};
+
+    if (polled < 0 && errno == EINTR)
+      continue;
+
+    if (polled == 0) {
+      _failed = has_exited(_peer);
+
+      continue;
+    }
+
+    ssize_t received{polled > 0 ? recv(_fd, bytes, size, 0) : -1};
+
+    if (received < 0 && errno == EINTR)
+      continue;
+
+    if (received <= 0) {
+      _failed = true;
+
+      break;
+    }
+
+    bytes += received;
+    size -= received;
+  }
+
+  if (size)
+    std::memset(bytes, 0, size);
+}
+
+// shuts the socket down rather than closing it, as the other processes'
+// copies would keep it open
+void SocketChannel::close() {
+  shutdown(_fd, SHUT_RDWR);
+}
+
+std::size_t Link::ring_bytes(std::size_t capacity) {
+  return ShmRing::bytes_needed(capacity) * 2;
+}
+
+Link Link::rings(void* memory, std::size_t capacity) {
+  auto* bytes{static_cast<std::uint8_t*>(memory)};
+  ShmRing forward(bytes, capacity);
+  ShmRing backward(bytes + ShmRing::bytes_needed(capacity), capacity);
+  Link link{};
+
+  link.ends[0] = std::make_unique<RingChannel>(forward, backward);
+  link.ends[1] = std::make_unique<RingChannel>(backward, forward);
+
+  return link;
+}
+
+// the send buffers are enlarged so both ends can send a full turn's
+// messages before either receives
+Link Link::socket(std::size_t buffer) {
+  int fds[2]{-1, -1};
+  Link link{};
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    return link;
+
+  int size(buffer);
+
+  for (const auto fd : fds)
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+  link.ends[0] = std::make_unique<SocketChannel>(fds[0]);
+  link.ends[1] = std::make_unique<SocketChannel>(fds[1]);
+
+  return link;
+}
\ No newline at end of file
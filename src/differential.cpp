@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <memory>
+
+#include "differential.hpp"
+#include "util.hpp"
+#include "tile_map.hpp"
+#include "tile_type.hpp"
+#include "walk_map.hpp"
+#include "room_generator.hpp"
+#include "event_consumers.hpp"
+#include "bunny_manager.hpp"
+#include "reference_manager.hpp"
+
+namespace differential {
+  static const TileType floor_tile{TileType::dirt};
+  static const TileType wall_tile{TileType::wall};
+  static const int context_events{4}; // shown before a diverging event
+
+  static const char *const event_type_str[] {
+    "born", "moved", "infected", "died", "culled", "removed", "shortage",
+    "roster_begin", "remaining", "roster_end"
+  };
+
+  // keeps a copy of the last batch; the roster is asked for so the turn
+  // order is compared as well
+  class Capture : public EventConsumer {
+  public:
+    EventBatch batch{};
+
+    void consume(const EventBatch& batch) override {
+      this->batch.turn = batch.turn;
+      this->batch.events.assign(batch.events.begin(), batch.events.end());
+    }
+
+    bool wants_roster() const override { return true; }
+  };
+
+  // Each engine draws from its own copy of the random engine so neither
+  // sees the other's draws; both copies start from the same seed.
+  class UseRng {
+    util::rng_t& _engine;
+    util::rng_t _saved{};
+
+  public:
+    explicit UseRng(util::rng_t& engine) :
+      _engine(engine), _saved(util::rng())
+    {
+      util::rng() = _engine;
+    }
+
+    ~UseRng() {
+      _engine = util::rng();
+      util::rng() = _saved;
+    }
+  };
+
+  // everything but the pool handle, which the reference does not have
+  static bool same(const TurnEvent& a, const TurnEvent& b) {
+    return a.type == b.type && a.colour == b.colour &&
+      a.gender == b.gender && a.flags == b.flags && a.floor == b.floor &&
+      a.age == b.age && a.name == b.name && a.id == b.id &&
+      a.mother == b.mother && a.pos == b.pos && a.from == b.from;
+  }
+
+  static void describe(std::ostream& out, const TurnEvent& event) {
+    out << event_type_str[(int)event.type];
+
+    if (event.type == EventType::shortage ||
+      event.type == EventType::roster_begin ||
+      event.type == EventType::roster_end)
+    {
+      return;
+    }
+
+    out << " id " << event.id << " at (" << event.pos.x << ", " <<
+      event.pos.y << ") age " << event.age << " colour " <<
+      (int)event.colour << " gender " << (int)event.gender << " flags " <<
+      (int)event.flags << " name " << event.name;
+
+    if (event.type == EventType::moved)
+      out << " from (" << event.from.x << ", " << event.from.y << ")";
+
+    if (event.floor)
+      out << " floor " << (int)event.floor;
+
+    if (event.mother != Bunny::no_id)
+      out << " mother " << event.mother;
+  }
+
+  static bool compare_events(const EventBatch& reference,
+    const EventBatch& optimised, std::ostream& out)
+  {
+    const auto& ref{reference.events};
+    const auto& opt{optimised.events};
+    std::size_t count{std::min(ref.size(), opt.size())};
+    std::size_t i{0};
+
+    while (i < count && same(ref[i], opt[i]))
+      i++;
+
+    if (i == ref.size() && i == opt.size())
+      return true;
+
+    out << "Events diverge at index " << i << " of " << ref.size() <<
+      " (reference) and " << opt.size() << " (optimised)\n";
+
+    for (std::size_t j{i - std::min<std::size_t>(i, context_events)}; j < i;
+      j++)
+    {
+      out << "    ";
+      describe(out, ref[j]);
+      out << "\n";
+    }
+
+    out << "  reference: ";
+
+    if (i < ref.size())
+      describe(out, ref[i]);
+
+    else
+      out << "(end of turn)";
+
+    out << "\n  optimised: ";
+
+    if (i < opt.size())
+      describe(out, opt[i]);
+
+    else
+      out << "(end of turn)";
+
+    out << "\n";
+
+    return false;
+  }
+
+  static bool compare_tiles(const TileMap& reference,
+    const TileMap& optimised, std::ostream& out)
+  {
+    for (int r{0}; r < reference.height(); r++) {
+      for (int c{0}; c < reference.width(); c++) {
+        int ref_tile{reference.get_tile(c, r)};
+        int opt_tile{optimised.get_tile(c, r)};
+
+        if (ref_tile == opt_tile)
+          continue;
+
+        out << "Tile (" << c << ", " << r << ") is " <<
+          tile_type_str[ref_tile] << " in the reference and " <<
+          tile_type_str[opt_tile] << " in the optimised engine\n";
+
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool run(const Case& test_case, std::ostream& out) {
+    util::rng_t saved{util::rng()};
+
+    util::seed(test_case.seed);
+
+    TileMap ref_tiles(test_case.size, test_case.size, 1, (int)floor_tile);
+    WalkMap walk_map{};
+
+    // the terrain is generated once, before either engine draws
+    if (test_case.rooms) {
+      RoomGenerator room_generator(ref_tiles.width(), ref_tiles.height());
+
+      room_generator.gen();
+      room_generator.carve(ref_tiles, (int)floor_tile, (int)wall_tile);
+      walk_map.build(ref_tiles, (int)wall_tile);
+    }
+
+    const WalkMap* walk{test_case.rooms ? &walk_map : nullptr};
+    TileMap opt_tiles{ref_tiles};
+    util::rng_t ref_rng{util::rng()};
+    util::rng_t opt_rng{util::rng()};
+    util::rng() = saved;
+
+    Capture ref_capture{};
+    Capture opt_capture{};
+    TilePainter tile_painter(opt_tiles);
+
+    std::unique_ptr<ReferenceManager> reference{};
+    std::unique_ptr<BasicBunnyManager<rules::Classic>> optimised{};
+
+    {
+      UseRng use(ref_rng);
+
+      reference = std::make_unique<ReferenceManager>(ref_tiles, floor_tile,
+        std::vector<EventConsumer*>{&ref_capture}, walk);
+    }
+
+    {
+      UseRng use(opt_rng);
+
+      optimised = std::make_unique<BasicBunnyManager<rules::Classic>>(
+        opt_tiles, floor_tile,
+        std::vector<EventConsumer*>{&tile_painter, &opt_capture}, walk);
+    }
+
+    for (int turn{0}; turn <= test_case.turns; turn++) {
+      bool ref_extinct{false};
+      bool opt_extinct{false};
+
+      if (turn > 0) {
+        {
+          UseRng use(ref_rng);
+          ref_extinct = reference->next_turn();
+
+          // the run carries on from a fresh spawn
+          if (ref_extinct)
+            reference->reset();
+        }
+
+        {
+          UseRng use(opt_rng);
+          opt_extinct = optimised->next_turn();
+
+          if (opt_extinct)
+            optimised->reset();
+        }
+      }
+
+      if (ref_extinct != opt_extinct) {
+        out << "Turn " << turn << ": only the " <<
+          (ref_extinct ? "reference" : "optimised") << " engine died out\n";
+
+        return false;
+      }
+
+      int ref_population{reference->population()};
+      int opt_population{optimised->bunnies().size()};
+
+      if (compare_events(ref_capture.batch, opt_capture.batch, out) &&
+        compare_tiles(ref_tiles, opt_tiles, out) &&
+        ref_population == opt_population)
+      {
+        continue;
+      }
+
+      if (ref_population != opt_population) {
+        out << "Population is " << ref_population << " in the reference and "
+          << opt_population << " in the optimised engine\n";
+      }
+
+      out << "Turn " << turn << (ref_extinct ? " (after a reset)" : "") <<
+        " of seed " << test_case.seed << ", size " << test_case.size <<
+        (test_case.rooms ? " with rooms" : "") << "\n";
+
+      return false;
+    }
+
+    return true;
+  }
+
+  int stress(const std::vector<std::uint32_t>& seeds,
+    const std::vector<int>& sizes, int turns, std::ostream& out)
+  {
+    int cases{0};
+
+    for (const auto seed : seeds) {
+      for (const auto size : sizes) {
+        for (const bool rooms : {false, true}) {
+          cases++;
+
+          if (!run({seed, size, rooms, turns}, out))
+            return 1;
+        }
+      }
+    }
+
+    out << cases << " cases of " << turns << " turns matched\n";
+
+    return 0;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "domain_coordinator.hpp"
+#include "util.hpp"
+
+using namespace domain;
+
+// room for a turn's worst case traffic on a link (a migrant and an
+// infection for every cell of an edge row, plus the halo) twice over
+static std::size_t link_capacity(int width) {
+  return (sizeof(Bunny) + sizeof(sf::Vector2i) * 2 + 2) * width * 2 + 4096;
+}
+
+DomainCoordinator::DomainCoordinator(int width, int height, int workers,
+  Transport transport, int bunny_limit, int initial_spawn) :
+    _width(width),
+    _height(height),
+    _bunny_limit(bunny_limit),
+    _initial_spawn(initial_spawn)
+{
+  workers = std::clamp(workers, 1, height);
+
+  for (int i{0}; i <= workers; i++)
+    _row_begins.push_back(height * i / workers);
+
+  const int link_count{workers * 2 - 1};
+  const std::size_t capacity{link_capacity(width)};
+
+  if (transport == Transport::shm) {
+    _memory = SharedMemory(Link::ring_bytes(capacity) * link_count);
+
+    if (!_memory.valid())
+      return;
+
+    auto* bytes{static_cast<std::uint8_t*>(_memory.data())};
+
+    for (int i{0}; i < link_count; i++)
+      _links.push_back(Link::rings(bytes + Link::ring_bytes(capacity) * i,
+        capacity));
+  }
+
+  else {
+    for (int i{0}; i < link_count; i++) {
+      _links.push_back(Link::socket(capacity));
+
+      if (!_links.back().ends[0])
+        return;
+    }
+  }
+
+  // drawn up front so every worker gets its own sequence
+  std::vector<std::uint32_t> seeds(workers);
+
+  for (auto& seed : seeds)
+    seed = util::rng()();
+
+  const int coordinator{getpid()};
+
+  for (int i{0}; i < workers; i++) {
+    int pid{fork()};
+
+    if (pid < 0)
+      break;
+
+    if (pid == 0) {
+      util::seed(seeds[i]);
+
+      Channel* above{i > 0 ? _links[workers + i - 1].ends[1].get() : nullptr};
+      Channel* below{
+        i < workers - 1 ? _links[workers + i].ends[0].get() : nullptr
+      };
+
+      Channel& channel{*_links[i].ends[1]};
+
+      // a worker whose coordinator has died gives up instead of waiting on
+      // it or on a neighbour forever
+      for (const auto end : {&channel, above, below}) {
+        if (end)
+          end->watch(coordinator);
+      }
+
+      StripWorker strip(_width, _row_begins[i], _row_begins[i + 1], channel,
+        above, below);
+
+      strip.run();
+
+      for (const auto end : {&channel, above, below}) {
+        if (end)
+          end->close();
+      }
+
+      // skips the parent's destructors, which would stop the workers
+      _exit(0);
+    }
+
+    _pids.push_back(pid);
+    worker(i).watch(Channel::any_child);
+  }
+
+  _reports.resize(workers);
+
+  if (started())
+    reset();
+}
+
+// Closing every link after the stop lets workers still waiting on a failed
+// neighbour give up; a stop already written is still read.
+DomainCoordinator::~DomainCoordinator() {
+  for (int i{0}; i < (int)_pids.size(); i++)
+    worker(i).send_value(Command{CommandType::stop});
+
+  for (auto& link : _links) {
+    for (auto& end : link.ends)
+      end->close();
+  }
+
+  for (const auto pid : _pids)
+    waitpid(pid, nullptr, 0);
+}
+
+Channel& DomainCoordinator::worker(int index) {
+  return *_links[index].ends[0];
+}
+
+void DomainCoordinator::broadcast(CommandType type, int value) {
+  for (int i{0}; i < workers(); i++)
+    worker(i).send_value(Command{type, value});
+}
+
+bool DomainCoordinator::started() const {
+  return !_pids.empty() && (int)_pids.size() == (int)_row_begins.size() - 1;
+}
+
+int DomainCoordinator::workers() const { return _pids.size(); }
+
+bool DomainCoordinator::failed() const {
+  for (int i{0}; i < workers(); i++) {
+    if (_links[i].ends[0]->failed())
+      return true;
+  }
+
+  return false;
+}
+const TurnStats& DomainCoordinator::last() const { return _last; }
+const TurnStats& DomainCoordinator::total() const { return _total; }
+
+bool DomainCoordinator::next_turn() {
+  if (_total.population == 0 || failed())
+    return true;
+
+  broadcast(CommandType::turn);
+
+  int breedable_males{0};
+
+  for (int i{0}; i < workers(); i++)
+    breedable_males += worker(i).receive_value<int>();
+
+  broadcast(CommandType::breed, breedable_males > 0);
+
+  _last = TurnStats{};
+  _last.turn = _total.turn + 1;
+
+  for (int i{0}; i < workers(); i++) {
+    _reports[i] = worker(i).receive_value<TurnStats>();
+    _last.births += _reports[i].births;
+    _last.deaths += _reports[i].deaths;
+    _last.infections += _reports[i].infections;
+    _last.moves += _reports[i].moves;
+    _last.population += _reports[i].population;
+  }
+
+  // Culling half the world at random is a shuffle over every bunny, as in
+  // BasicBunnyManager; each strip is told how many of its bunnies drew a
+  // cull and picks those at random itself.
+  if (_last.population > _bunny_limit) {
+    _cull_bunnies.assign(_last.population, true);
+
+    std::fill(_cull_bunnies.begin(),
+      _cull_bunnies.begin() + _bunny_limit / 2, false);
+
+    std::shuffle(_cull_bunnies.begin(), _cull_bunnies.end(), util::rng());
+  }
+
+  int first{0};
+
+  for (int i{0}; i < workers(); i++) {
+    int culls{0};
+
+    if (_last.population > _bunny_limit) {
+      culls = std::count(_cull_bunnies.begin() + first,
+        _cull_bunnies.begin() + first + _reports[i].population, true);
+    }
+
+    first += _reports[i].population;
+    _last.culls += culls;
+    worker(i).send_value(Command{CommandType::cull, culls});
+  }
+
+  _last.population -= _last.culls;
+
+  _total.turn = _last.turn;
+  _total.births += _last.births;
+  _total.deaths += _last.deaths;
+  _total.infections += _last.infections;
+  _total.culls += _last.culls;
+  _total.moves += _last.moves;
+  _total.population = _last.population;
+
+  return false;
+}
+
+// the initial bunnies land in each strip in proportion to its rows
+void DomainCoordinator::reset() {
+  std::vector<int> spawns(workers());
+
+  for (int i{0}; i < _initial_spawn; i++) {
+    int row{util::rnd_range(0, _height - 1)};
+    auto strip{std::upper_bound(_row_begins.begin(), _row_begins.end(), row)};
+
+    spawns[strip - _row_begins.begin() - 1]++;
+  }
+
+  _total = TurnStats{};
+
+  for (int i{0}; i < workers(); i++)
+    worker(i).send_value(Command{CommandType::spawn, spawns[i]});
+
+  for (int i{0}; i < workers(); i++)
+    _total.population += worker(i).receive_value<TurnStats>().population;
+
+  _last = _total;
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include <charconv>
+
+#include "event_consumers.hpp"
+#include "bunny_names.hpp"
+
+// [colour][adult][infected]
+static const TileType bunny_tiles[][2][2] {
+  {
+    {TileType::white_juvenile, TileType::white_juvenile_mutant},
+    {TileType::white_adult, TileType::white_adult_mutant}
+  },
+  {
+    {TileType::brown_juvenile, TileType::brown_juvenile_mutant},
+    {TileType::brown_adult, TileType::brown_adult_mutant}
+  },
+  {
+    {TileType::black_juvenile, TileType::black_juvenile_mutant},
+    {TileType::black_adult, TileType::black_adult_mutant}
+  },
+  {
+    {TileType::spotted_juvenile, TileType::spotted_juvenile_mutant},
+    {TileType::spotted_adult, TileType::spotted_adult_mutant}
+  }
+};
+
+TileType TilePainter::bunny_tile(const TurnEvent& event) {
+  return bunny_tiles[event.colour][event.adult()][event.infected()];
+}
+
+TilePainter::TilePainter(TileMap& tile_map) : _tile_map(tile_map) {}
+
+void TilePainter::consume(const EventBatch& batch) {
+  for (const auto& event : batch.events) {
+    switch (event.type) {
+      case EventType::moved:
+        _tile_map.set_tile(event.from.x, event.from.y, event.floor);
+        _tile_map.set_tile(event.pos.x, event.pos.y, (int)bunny_tile(event));
+
+        break;
+
+      case EventType::born:
+      case EventType::infected:
+        _tile_map.set_tile(event.pos.x, event.pos.y, (int)bunny_tile(event));
+
+        break;
+
+      case EventType::died:
+      case EventType::culled:
+      case EventType::removed:
+        _tile_map.set_tile(event.pos.x, event.pos.y, event.floor);
+
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+static void append_int(std::string& str, int value) {
+  char buf[16];
+  auto result{std::to_chars(buf, buf + sizeof(buf), value)};
+
+  str.append(buf, result.ptr);
+}
+
+TextLogger::TextLogger(Logger& logger, bool roster) :
+  _logger(logger), _roster(roster)
+{
+  _line.reserve(128);
+}
+
+bool TextLogger::wants_roster() const { return _roster; }
+
+// lines are built in a reused buffer so logging does not allocate
+void TextLogger::log_bunny(const TurnEvent& event, std::string_view what) {
+  if (event.infected())
+    _logger.log("Infected ");
+
+  _line.clear();
+  _line.append("Bunny ");
+  _line.append(bunny_names[event.name]);
+  _line.append(what);
+  _line.append("(");
+  append_int(_line, event.age);
+  _line.append(" years old, ");
+  _line.append((Gender)event.gender == Gender::male ? "male" : "female");
+  _line.append(", ");
+  _line.append(bunny_colour_str[event.colour]);
+  _line.append(")");
+
+  if (event.type == EventType::remaining) {
+    _line.append(" at (");
+    append_int(_line, event.pos.x);
+    _line.append(", ");
+    append_int(_line, event.pos.y);
+    _line.append(")");
+  }
+
+  _line.append("\n");
+  _logger.log(_line);
+}
+
+void TextLogger::consume(const EventBatch& batch) {
+  _logger.begin_turn(batch.turn);
+
+  for (const auto& event : batch.events) {
+    switch (event.type) {
+      case EventType::born:
+        log_bunny(event, " was born! ");
+
+        break;
+
+      case EventType::died:
+        log_bunny(event, " died! ");
+
+        break;
+
+      case EventType::shortage:
+        _logger.log("Food shortage occured!\n");
+
+        break;
+
+      case EventType::roster_begin:
+        _logger.log("\nBunnies remaining: \n");
+
+        break;
+
+      case EventType::remaining:
+        log_bunny(event, " ");
+
+        break;
+
+      case EventType::roster_end:
+        _logger.log("\n");
+
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  // the initial spawn is followed by a blank line
+  if (batch.turn == 0)
+    _logger.log("\n");
+}
+
+const TurnStats& StatsCollector::last() const { return _last; }
+const TurnStats& StatsCollector::total() const { return _total; }
+
+void StatsCollector::consume(const EventBatch& batch) {
+  _last = TurnStats{};
+  _last.turn = batch.turn;
+
+  for (const auto& event : batch.events) {
+    switch (event.type) {
+      case EventType::born:
+        _last.births++;
+
+        break;
+
+      case EventType::died:
+        _last.deaths++;
+
+        break;
+
+      case EventType::infected:
+        _last.infections++;
+
+        break;
+
+      case EventType::culled:
+        _last.culls++;
+
+        break;
+
+      case EventType::moved:
+        _last.moves++;
+
+        break;
+
+      case EventType::removed:
+        _total.population--;
+
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  _total.turn = batch.turn;
+  _total.births += _last.births;
+  _total.deaths += _last.deaths;
+  _total.infections += _last.infections;
+  _total.culls += _last.culls;
+  _total.moves += _last.moves;
+  _total.population += _last.births - _last.deaths - _last.culls;
+  _last.population = _total.population;
+}
+
+EventRecorder::EventRecorder(std::string_view file_name) :
+  _ofs(std::string(file_name), std::ios::binary) {}
+
+void EventRecorder::consume(const EventBatch& batch) {
+  std::int32_t turn{batch.turn};
+  std::uint32_t count(batch.events.size());
+
+  _ofs.write(reinterpret_cast<const char*>(&turn), sizeof(turn));
+  _ofs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  _ofs.write(reinterpret_cast<const char*>(batch.events.data()),
+    count * sizeof(TurnEvent));
+}
+
+AsyncConsumer::AsyncConsumer(EventConsumer& inner) :
+  _inner(inner), _worker(&AsyncConsumer::run, this) {}
+
+AsyncConsumer::~AsyncConsumer() {
+  flush();
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+
+  _cv.notify_all();
+  _worker.join();
+}
+
+bool AsyncConsumer::wants_roster() const { return _inner.wants_roster(); }
+bool AsyncConsumer::wants_timings() const { return _inner.wants_timings(); }
+
+void AsyncConsumer::consume(const EventBatch& batch) {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _cv.wait(lock, [this]() { return !_has_pending; });
+
+  // assign reuses the pending buffer's capacity
+  _pending.turn = batch.turn;
+  _pending.events.assign(batch.events.begin(), batch.events.end());
+  _pending.timings = batch.timings;
+  _has_pending = true;
+
+  lock.unlock();
+  _cv.notify_all();
+}
+
+void AsyncConsumer::flush() {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _cv.wait(lock, [this]() { return !_has_pending && !_busy; });
+}
+
+void AsyncConsumer::run() {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  while (true) {
+    _cv.wait(lock, [this]() { return _stop || _has_pending; });
+
+    if (!_has_pending)
+      return;
+
+    std::swap(_pending, _working);
+    _has_pending = false;
+    _busy = true;
+    lock.unlock();
+    _cv.notify_all();
+
+    _inner.consume(_working);
+
+    lock.lock();
+    _busy = false;
+    _cv.notify_all();
+  }
+}
+
+TelemetryPublisher::TelemetryPublisher(TelemetryWriter& writer) :
+  _writer(writer) {}
+
+bool TelemetryPublisher::wants_timings() const { return true; }
+
+void TelemetryPublisher::consume(const EventBatch& batch) {
+  _stats.consume(batch);
+
+  for (const auto& event : batch.events) {
+    switch (event.type) {
+      case EventType::born:
+        _infected += event.infected();
+
+        break;
+
+      case EventType::infected:
+        _infected++;
+
+        break;
+
+      case EventType::died:
+      case EventType::culled:
+      case EventType::removed:
+        _infected -= event.infected();
+
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  const TurnStats& last{_stats.last()};
+  TelemetryRecord record{};
+
+  record.turn = batch.turn;
+  record.population = last.population;
+  record.infected = _infected;
+  record.births = last.births;
+  record.deaths = last.deaths;
+  record.infections = last.infections;
+  record.culls = last.culls;
+  record.moves = last.moves;
+  record.timings = batch.timings;
+
+  _writer.publish(record);
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <algorithm>
+
+#include "food_field.hpp"
+#include "memory_usage.hpp"
+
+int FoodField::width() const { return _width; }
+int FoodField::height() const { return _height; }
+const std::vector<std::uint8_t>& FoodField::data() const { return _food; }
+
+std::size_t FoodField::memory_bytes() const {
+  return memory_usage::bytes(_food) + memory_usage::bytes(_next) +
+    memory_usage::bytes(_mask) + memory_usage::bytes(_full_turns) +
+    memory_usage::bytes(_skip);
+}
+
+FoodField::FoodField(int width, int height, std::uint8_t regrow, int threads,
+  const WalkMap* walk_map) :
+    _width(width),
+    _height(height),
+    _food(width * height),
+    _next(width * height),
+    _mask(width * height, 0xff),
+    _regrow(regrow),
+    _strips((width + block_cols - 1) / block_cols),
+    _full_turns((height + block_rows - 1) / block_rows * _strips),
+    _skip(_full_turns.size())
+{
+  if (walk_map) {
+    for (int cell{0}; cell < width * height; cell++)
+      _mask[cell] = walk_map->walkable(cell) ? 0xff : 0;
+  }
+
+  if (threads > 1)
+    _pool = std::make_unique<ThreadPool>(threads);
+
+  fill(max_food);
+}
+
+void FoodField::fill(std::uint8_t food) {
+  for (int cell{0}; cell < _width * _height; cell++)
+    _food[cell] = food & _mask[cell];
+
+  // the other buffer still holds the old food
+  std::fill(_full_turns.begin(), _full_turns.end(), 0);
+}
+
+bool FoodField::settled(int block_row, int block_col) const {
+  const int rows{(int)_full_turns.size() / _strips};
+
+  if (block_row < 0 || block_row >= rows || block_col < 0 ||
+    block_col >= _strips)
+  {
+    return true;
+  }
+
+  return _full_turns[block_row * _strips + block_col] >= 2;
+}
+
+static int stencil(int centre, int up, int down, int left, int right,
+  int regrow)
+{
+  return std::min((centre * 4 + up + down + left + right) >> 3,
+    255 - regrow) + regrow;
+}
+
+// restrict parameters let the compiler vectorise the row without runtime
+// alias checks; returns zero when every cell came out full
+static int stencil_row(const std::uint8_t* __restrict row,
+  const std::uint8_t* __restrict up, const std::uint8_t* __restrict down,
+  const std::uint8_t* __restrict mask, std::uint8_t* __restrict out,
+  int begin, int end, int regrow)
+{
+  std::uint8_t missing{0};
+
+  for (int c{begin}; c < end; c++) {
+    out[c] = stencil(row[c], up[c], down[c], row[c - 1], row[c + 1], regrow) &
+      mask[c];
+
+    missing |= out[c] ^ mask[c];
+  }
+
+  return missing;
+}
+
+// new = min(max, (4 * centre + up + down + left + right) / 8 + regrow)
+// with neighbours outside the grid replaced by the centre cell
+void FoodField::update_block(int block) {
+  if (_skip[block])
+    return;
+
+  const int r0{block / _strips * block_rows};
+  const int c0{block % _strips * block_cols};
+  const int r1{std::min(r0 + block_rows, _height)};
+  const int c1{std::min(c0 + block_cols, _width)};
+  const int regrow{_regrow};
+  int missing{0};
+
+  for (int r{r0}; r < r1; r++) {
+    const std::uint8_t* row{&_food[r * _width]};
+    const std::uint8_t* up{r > 0 ? row - _width : row};
+    const std::uint8_t* down{r < _height - 1 ? row + _width : row};
+    const std::uint8_t* mask{&_mask[r * _width]};
+    std::uint8_t* out{&_next[r * _width]};
+
+    missing |= stencil_row(row, up, down, mask, out, std::max(c0, 1),
+      std::min(c1, _width - 1), regrow);
+
+    if (c0 == 0) {
+      int right{_width > 1 ? row[1] : row[0]};
+
+      out[0] = stencil(row[0], up[0], down[0], row[0], right, regrow) &
+        mask[0];
+
+      missing |= out[0] ^ mask[0];
+    }
+
+    if (c1 == _width && _width > 1) {
+      int c{_width - 1};
+
+      out[c] = stencil(row[c], up[c], down[c], row[c - 1], row[c], regrow) &
+        mask[c];
+
+      missing |= out[c] ^ mask[c];
+    }
+  }
+
+  _full_turns[block] = missing ? 0 : std::min(_full_turns[block] + 1, 2);
+}
+
+// Blocks only read their own flags while updating, so which to skip is
+// decided for all of them first.
+void FoodField::update() {
+  const int blocks(_full_turns.size());
+
+  for (int block{0}; block < blocks; block++) {
+    const int br{block / _strips};
+    const int bc{block % _strips};
+
+    _skip[block] = settled(br, bc) && settled(br - 1, bc) &&
+      settled(br + 1, bc) && settled(br, bc - 1) && settled(br, bc + 1);
+  }
+
+  if (_pool)
+    _pool->parallel_for(blocks, [this](int block) { update_block(block); });
+
+  else {
+    for (int block{0}; block < blocks; block++)
+      update_block(block);
+  }
+
+  _food.swap(_next);
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <SFML/Graphics/Image.hpp>
+#include <cstdio>
+#include <fstream>
+
+#include "frame_exporter.hpp"
+
+FrameExporter::FrameExporter(const TileRaster& raster, int width, int height,
+  std::string_view dir, FrameFormat format, int threads) :
+    _raster(raster),
+    _dir(dir),
+    _format(format),
+    _width(width),
+    _height(height),
+    _pool(threads)
+{
+  const int px{raster.tile_px()};
+
+  _frames.resize(_pool.size() * 2);
+
+  for (int i{0}; i < (int)_frames.size(); i++) {
+    _frames[i].cells.resize(width * height);
+    _frames[i].pixels.resize(width * px * height * px * TileRaster::channels);
+    _free.push_back(i);
+  }
+}
+
+int FrameExporter::failed() const { return _failed; }
+
+bool FrameExporter::write(Frame& frame) const {
+  const int frame_width{_width * _raster.tile_px()};
+  const int frame_height{_height * _raster.tile_px()};
+
+  char name[32];
+
+  std::snprintf(name, sizeof(name), "/frame_%06d.%s", frame.number,
+    _format == FrameFormat::png ? "png" : "ppm");
+
+  std::string path{_dir + name};
+
+  if (_format == FrameFormat::png) {
+    sf::Image image{};
+
+    image.create(frame_width, frame_height, frame.pixels.data());
+
+    return image.saveToFile(path);
+  }
+
+  // pack RGBA down to RGB in place
+  std::uint8_t* pixels{frame.pixels.data()};
+  const int count{frame_width * frame_height};
+
+  for (int i{0}; i < count; i++) {
+    pixels[i * 3] = pixels[i * TileRaster::channels];
+    pixels[i * 3 + 1] = pixels[i * TileRaster::channels + 1];
+    pixels[i * 3 + 2] = pixels[i * TileRaster::channels + 2];
+  }
+
+  std::ofstream ofs(path, std::ios::binary);
+
+  ofs << "P6\n" << frame_width << " " << frame_height << "\n255\n";
+  ofs.write(reinterpret_cast<const char*>(pixels), count * 3);
+
+  return (bool)ofs;
+}
+
+void FrameExporter::encode(int slot) {
+  Frame& frame{_frames[slot]};
+
+  _raster.rasterise(frame.cells.data(), _width, 0, _height,
+    frame.pixels.data());
+
+  if (!write(frame))
+    _failed++;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _free.push_back(slot);
+  }
+
+  _free_cv.notify_one();
+}
+
+void FrameExporter::capture(const TileMap& tile_map, int number) {
+  int slot{};
+
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _free_cv.wait(lock, [this]() { return !_free.empty(); });
+    slot = _free.back();
+    _free.pop_back();
+  }
+
+  Frame& frame{_frames[slot]};
+
+  frame.number = number;
+
+  for (int r{0}; r < _height; r++) {
+    const auto& row{tile_map.data()[r]};
+
+    for (int c{0}; c < _width; c++)
+      frame.cells[r * _width + c] = row[c];
+  }
+
+  _pool.submit([this, slot]() { encode(slot); });
+}
+
+void FrameExporter::finish() { _pool.wait(); }
\ No newline at end of file
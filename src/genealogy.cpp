@@ -0,0 +1,186 @@
+#include "genealogy.hpp"
+
+std::size_t Genealogy::births() const { return _mothers.size(); }
+
+std::size_t Genealogy::memory_bytes() const {
+  return _mothers.memory_bytes() + _lines.memory_bytes() +
+    _infected.memory_bytes();
+}
+
+std::size_t Genealogy::index(std::uint32_t id) const { return id - _first_id; }
+
+bool Genealogy::known(std::uint32_t id) const {
+  return _first_id != Bunny::no_id && id != Bunny::no_id &&
+    id >= _first_id && index(id) < _mothers.size();
+}
+
+std::uint32_t Genealogy::mother(std::uint32_t id) const {
+  return _mothers[index(id)];
+}
+
+bool Genealogy::infected(std::uint32_t id) const {
+  std::size_t i{index(id)};
+
+  return _infected[i / 64] >> (i % 64) & 1;
+}
+
+int Genealogy::line(std::uint32_t id) const {
+  std::uint16_t line{_lines[index(id)]};
+
+  return line == max_lines ? no_line : line;
+}
+
+int Genealogy::lines() const { return _founders.size(); }
+std::uint32_t Genealogy::founder(int line) const { return _founders[line]; }
+int Genealogy::population() const { return _population; }
+
+int Genealogy::line_population(int line) const {
+  return _line_population[line];
+}
+
+double Genealogy::line_share(int line) const {
+  return _population ? (double)_line_population[line] / _population : 0;
+}
+
+int Genealogy::dominant_line() const {
+  int best{no_line};
+
+  for (int line{0}; line < lines(); line++) {
+    if (_line_population[line] > 0 &&
+      (best == no_line || _line_population[line] > _line_population[best]))
+    {
+      best = line;
+    }
+  }
+
+  return best;
+}
+
+void Genealogy::set_infected(std::size_t i) {
+  _infected[i / 64] |= std::uint64_t(1) << (i % 64);
+}
+
+// births missed before the consumer was attached are left as unknown
+// founders so ids keep indexing the arrays directly
+void Genealogy::add_birth(const TurnEvent& event) {
+  if (_first_id == Bunny::no_id)
+    _first_id = event.id;
+
+  while (_mothers.size() <= index(event.id)) {
+    if (_mothers.size() % 64 == 0)
+      _infected.push_back(0);
+
+    _mothers.push_back(Bunny::no_id);
+    _lines.push_back(max_lines);
+  }
+
+  std::size_t i{index(event.id)};
+  int line{no_line};
+
+  if (known(event.mother) && event.mother < event.id) {
+    _mothers[i] = event.mother;
+    line = this->line(event.mother);
+  }
+
+  // founder lines past max_lines are not tracked
+  else if (lines() < max_lines) {
+    line = lines();
+    _founders.push_back(event.id);
+    _line_population.push_back(0);
+  }
+
+  _lines[i] = line == no_line ? max_lines : line;
+
+  if (event.infected())
+    set_infected(i);
+
+  if (line != no_line)
+    _line_population[line]++;
+
+  _population++;
+}
+
+void Genealogy::end_life(const TurnEvent& event) {
+  if (!known(event.id))
+    return;
+
+  int line{this->line(event.id)};
+
+  if (line != no_line)
+    _line_population[line]--;
+
+  _population--;
+}
+
+Genealogy::Descendants Genealogy::descendants(std::uint32_t id) {
+  Descendants result{};
+
+  if (!known(id))
+    return result;
+
+  const std::size_t first{index(id)};
+  const std::size_t count{_mothers.size() - first};
+
+  _marks.assign(count / 64 + 1, 0);
+  _marks[0] = 1; // id itself
+
+  for (std::size_t i{first + 1}; i < _mothers.size(); i++) {
+    std::uint32_t mother{_mothers[i]};
+
+    if (mother == Bunny::no_id || mother < id)
+      continue;
+
+    std::size_t m{index(mother) - first};
+
+    if (!(_marks[m / 64] >> (m % 64) & 1))
+      continue;
+
+    std::size_t d{i - first};
+
+    _marks[d / 64] |= std::uint64_t(1) << (d % 64);
+    result.total++;
+
+    if (_infected[i / 64] >> (i % 64) & 1)
+      result.infected++;
+  }
+
+  return result;
+}
+
+void Genealogy::descendant_counts(std::vector<std::uint32_t>& counts) const {
+  counts.assign(_mothers.size(), 0);
+
+  for (std::size_t i{_mothers.size()}; i-- > 0;) {
+    std::uint32_t mother{_mothers[i]};
+
+    if (known(mother))
+      counts[index(mother)] += counts[i] + 1;
+  }
+}
+
+void Genealogy::consume(const EventBatch& batch) {
+  for (const auto& event : batch.events) {
+    switch (event.type) {
+      case EventType::born:
+        add_birth(event);
+
+        break;
+
+      case EventType::infected:
+        if (known(event.id))
+          set_infected(index(event.id));
+
+        break;
+
+      case EventType::died:
+      case EventType::culled:
+      case EventType::removed:
+        end_life(event);
+
+        break;
+
+      default:
+        break;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,818 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+#include "hybrid_world.hpp"
+#include "path_finding.hpp"
+#include "rule_draws.hpp"
+
+using Rules = rules::Classic;
+using rules::rnd_dirs;
+
+static float rnd_float() {
+  return std::uniform_real_distribution<float>{0, 1}(util::rng());
+}
+
+// rounds up with a chance of the fraction, keeping the expected value
+static int stochastic_round(double value) {
+  double whole{std::floor(value)};
+
+  return (int)whole + (rnd_float() < value - whole);
+}
+
+// chance that at least one of four independent neighbours has something
+// found at this density
+static float any_of_four(float density) {
+  float none{1 - density};
+
+  return 1 - none * none * none * none;
+}
+
+// How many times more often an infected bunny in a sparse block has a
+// healthy neighbour than the well-mixed estimate gives, by block density in
+// steps of 1/20, measured on agent blocks. Bunnies are born next to their
+// mothers, so a sparse block is crowded where its bunnies are. Above an
+// eighth the estimate is kept, although it is too high in dense blocks.
+static const std::array<float, 4> crowding{3.03f, 1.53f, 1.05f, 1.0f};
+
+// crowding interpolated between bin centres, flat beyond the table
+static float crowding_at(float density) {
+  float x{std::clamp(density * 20 - 0.5f, 0.0f, crowding.size() - 1.0f)};
+  int i{std::min((int)x, (int)crowding.size() - 2)};
+
+  return crowding[i] + (crowding[i + 1] - crowding[i]) * (x - i);
+}
+
+// a bunny of age a dies when a lifespan drawn uniformly from [min, max] is
+// at most a
+static float death_chance(int age, int min, int max) {
+  return std::clamp((age - min + 1) / float(max - min + 1), 0.0f, 1.0f);
+}
+
+static std::array<float, Cohort::bins> make_survival() {
+  std::array<float, Cohort::bins> survival{};
+
+  for (int age{0}; age < Cohort::ages; age++) {
+    for (int i{0}; i < Cohort::per_age; i++) {
+      survival[age * Cohort::per_age + i] = 1 - death_chance(age,
+        Rules::min_lifespan, Rules::max_lifespan);
+
+      survival[Cohort::per_state + age * Cohort::per_age + i] =
+        1 - death_chance(age, Rules::min_infected_lifespan,
+          Rules::max_infected_lifespan);
+    }
+  }
+
+  return survival;
+}
+
+static const std::array<float, Cohort::bins> survival{make_survival()};
+
+static int bin_of(const Bunny& bunny) {
+  return Cohort::bin(bunny.infected(), bunny.age(), bunny.colour(),
+    bunny.gender());
+}
+
+float Cohort::total() const {
+  float sum{0};
+
+  for (const auto count : counts)
+    sum += count;
+
+  return sum;
+}
+
+float Cohort::healthy() const {
+  float sum{0};
+
+  for (int i{0}; i < per_state; i++)
+    sum += counts[i];
+
+  return sum;
+}
+
+// moves amount of the healthy counts to the infected ones, spread in
+// proportion so ages, colours and genders keep their shares
+static void infect(Cohort& cohort, float amount) {
+  float healthy{cohort.healthy()};
+
+  if (healthy <= 0)
+    return;
+
+  float share{std::min(amount / healthy, 1.0f)};
+
+  for (int i{0}; i < Cohort::per_state; i++) {
+    float moved{cohort.counts[i] * share};
+
+    cohort.counts[i] -= moved;
+    cohort.counts[Cohort::per_state + i] += moved;
+  }
+}
+
+HybridWorld::HybridWorld(int width, int height, int bunny_limit,
+  int initial_spawn, Resolution resolution) :
+    _width(width),
+    _height(height),
+    _blocks_x((width + block_size - 1) / block_size),
+    _blocks_y((height + block_size - 1) / block_size),
+    _bunny_limit(bunny_limit),
+    _initial_spawn(initial_spawn),
+    _resolution(resolution)
+{
+  _blocks.resize(_blocks_x * _blocks_y);
+  _gone.resize(_blocks.size());
+  _densities.resize(_blocks.size());
+
+  for (int i{0}; i < (int)_blocks.size(); i++) {
+    int bx{i % _blocks_x};
+    int by{i / _blocks_x};
+
+    _blocks[i].cell_count = std::min(block_size, _width - bx * block_size) *
+      std::min(block_size, _height - by * block_size);
+  }
+
+  reset();
+}
+
+const HybridStats& HybridWorld::last() const { return _last; }
+const HybridStats& HybridWorld::total() const { return _total; }
+
+int HybridWorld::block_index(sf::Vector2i pos) const {
+  return pos.y / block_size * _blocks_x + pos.x / block_size;
+}
+
+int HybridWorld::local_cell(sf::Vector2i pos) const {
+  return pos.y % block_size * block_size + pos.x % block_size;
+}
+
+bool HybridWorld::in_world(sf::Vector2i pos) const {
+  return pos.x >= 0 && pos.x < _width && pos.y >= 0 && pos.y < _height;
+}
+
+float HybridWorld::density(const Block& block) const {
+  float bunnies(block.cohort ? block.counts->total() : block.agents.size());
+
+  return bunnies / block.cell_count;
+}
+
+float HybridWorld::healthy_density(const Block& block) const {
+  if (block.cohort)
+    return block.counts->healthy() / block.cell_count;
+
+  int healthy{0};
+
+  for (const auto& bunny : block.agents)
+    healthy += !bunny.infected();
+
+  return healthy / float(block.cell_count);
+}
+
+std::uint16_t& HybridWorld::cell(sf::Vector2i pos) {
+  return _blocks[block_index(pos)].cells[local_cell(pos)];
+}
+
+void HybridWorld::add_agent(int index, const Bunny& bunny) {
+  Block& block{_blocks[index]};
+
+  block.agents.push_back(bunny);
+  block.cells[local_cell(bunny.pos)] = block.agents.size();
+}
+
+void HybridWorld::rebuild_cells(Block& block) {
+  std::fill(block.cells.begin(), block.cells.end(), 0);
+
+  for (int i{0}; i < (int)block.agents.size(); i++)
+    block.cells[local_cell(block.agents[i].pos)] = i + 1;
+}
+
+void HybridWorld::to_cohort(Block& block) {
+  if (!block.counts)
+    block.counts = std::make_unique<Cohort>();
+
+  for (const auto& bunny : block.agents)
+    block.counts->counts[bin_of(bunny)] += 1;
+
+  // the per cell map is only needed by agents
+  block.agents.clear();
+  std::vector<std::uint16_t>().swap(block.cells);
+  block.cohort = true;
+}
+
+// Every bin is rounded to whole bunnies with the fraction as the chance of
+// one more, and each is put on a free cell. Cohorts only turn back at low
+// density so free cells are easy to find.
+void HybridWorld::to_agents(Block& block) {
+  int index(&block - _blocks.data());
+  std::unique_ptr<Cohort> cohort{std::move(block.counts)};
+
+  block.cohort = false;
+  block.cells.assign(block_size * block_size, 0);
+
+  for (int i{0}; i < Cohort::bins; i++) {
+    int amount{stochastic_round(cohort->counts[i])};
+    int age{i % Cohort::per_state / Cohort::per_age};
+    auto colour{BunnyColour(i % Cohort::per_age / Cohort::genders)};
+    auto gender{Gender(i % Cohort::genders)};
+
+    for (int j{0}; j < amount; j++) {
+      place_agent(index, Bunny(sf::Vector2i(), age, colour, gender,
+        i >= Cohort::per_state), block.cell_count);
+    }
+  }
+
+  std::stable_sort(block.agents.begin(), block.agents.end(),
+    [](const Bunny& b1, const Bunny& b2) { return b1.age() < b2.age(); });
+
+  rebuild_cells(block);
+}
+
+// puts bunny on a random free cell of an agent block, giving up after tries
+bool HybridWorld::place_agent(int index, const Bunny& bunny, int tries) {
+  const int left{index % _blocks_x * block_size};
+  const int top{index / _blocks_x * block_size};
+  const int width{std::min(block_size, _width - left)};
+  const int height{std::min(block_size, _height - top)};
+
+  for (int i{0}; i < tries; i++) {
+    sf::Vector2i pos(left + util::rnd_range(0, width - 1),
+      top + util::rnd_range(0, height - 1));
+
+    if (cell(pos))
+      continue;
+
+    Bunny placed{bunny};
+
+    placed.pos = pos;
+    add_agent(index, placed);
+
+    return true;
+  }
+
+  return false;
+}
+
+// an agent next to a cohort finds a healthy bunny with its healthy density
+bool HybridWorld::infect_cohort(Block& block, float chance) {
+  if (rnd_float() >= chance)
+    return false;
+
+  infect(*block.counts, 1);
+  _last.infections++;
+
+  return true;
+}
+
+void HybridWorld::mutate_adj(sf::Vector2i pos) {
+  for (const auto dir : rnd_dirs()) {
+    sf::Vector2i adj_pos{path_finding::traverse(pos, dir)};
+
+    if (!in_world(adj_pos))
+      continue;
+
+    Block& block{_blocks[block_index(adj_pos)]};
+
+    if (block.cohort) {
+      if (infect_cohort(block, healthy_density(block)))
+        break;
+
+      continue;
+    }
+
+    std::uint16_t agent{block.cells[local_cell(adj_pos)]};
+
+    if (!agent || block.agents[agent - 1].infected())
+      continue;
+
+    block.agents[agent - 1].infect();
+    _last.infections++;
+
+    break;
+  }
+}
+
+// Walks one agent block in age order. Steps into another block are queued
+// and made once every block has been walked, so no bunny moves twice; a
+// cohort's cells count as taken with its density as the chance.
+void HybridWorld::update_agents(int index) {
+  Block& block{_blocks[index]};
+  std::vector<std::uint8_t>& gone{_gone[index]};
+
+  gone.assign(block.agents.size(), 0);
+
+  for (int i{0}; i < (int)block.agents.size(); i++) {
+    Bunny& bunny{block.agents[i]};
+
+    if (rules::is_overaged<Rules>(bunny)) {
+      block.cells[local_cell(bunny.pos)] = 0;
+      gone[i] = 1;
+      _last.deaths++;
+
+      continue;
+    }
+
+    for (const auto dir : rnd_dirs()) {
+      sf::Vector2i new_pos{path_finding::traverse(bunny.pos, dir)};
+
+      if (!in_world(new_pos))
+        continue;
+
+      int to{block_index(new_pos)};
+      const Block& other{_blocks[to]};
+
+      if (other.cohort ? rnd_float() < density(other) :
+        other.cells[local_cell(new_pos)] != 0)
+      {
+        continue;
+      }
+
+      if (to != index) {
+        _migrations.push_back({index, i, to, new_pos});
+
+        break;
+      }
+
+      block.cells[local_cell(bunny.pos)] = 0;
+      bunny.pos = new_pos;
+      block.cells[local_cell(bunny.pos)] = i + 1;
+
+      break;
+    }
+
+    if (bunny.infected())
+      mutate_adj(bunny.pos);
+
+    bunny.grow(1);
+
+    if (!bunny.infected() && bunny.age() >= Rules::adult_age &&
+      bunny.gender() == Gender::male)
+    {
+      _breedable_males++;
+    }
+  }
+}
+
+// A migrant whose target cell was taken in the meantime stays put. One
+// moving into a cohort is only counted there after the cohort update.
+void HybridWorld::apply_migrations() {
+  for (const auto& migration : _migrations) {
+    Block& from{_blocks[migration.from]};
+    Block& to{_blocks[migration.to]};
+    Bunny bunny{from.agents[migration.agent]};
+
+    if (to.cohort)
+      _arrivals.push_back({migration.to, bin_of(bunny)});
+
+    else if (!to.cells[local_cell(migration.pos)]) {
+      bunny.pos = migration.pos;
+      add_agent(migration.to, bunny);
+    }
+
+    else
+      continue;
+
+    from.cells[local_cell(from.agents[migration.agent].pos)] = 0;
+    _gone[migration.from][migration.agent] = 1;
+  }
+
+  _migrations.clear();
+
+  // agents appended by migrations are past the end of the gone flags
+  for (int i{0}; i < (int)_blocks.size(); i++) {
+    Block& block{_blocks[i]};
+    std::vector<std::uint8_t>& gone{_gone[i]};
+
+    if (block.cohort || gone.empty())
+      continue;
+
+    std::size_t kept{0};
+
+    for (std::size_t j{0}; j < block.agents.size(); j++) {
+      if (j >= gone.size() || !gone[j])
+        block.agents[kept++] = block.agents[j];
+    }
+
+    block.agents.erase(block.agents.begin() + kept, block.agents.end());
+    gone.clear();
+    rebuild_cells(block);
+  }
+}
+
+// deaths, infections within the block and aging, in expectation
+void HybridWorld::update_cohort(Block& block) {
+  auto& counts{block.counts->counts};
+  float before{block.counts->total()};
+
+  for (int i{0}; i < Cohort::bins; i++)
+    counts[i] *= survival[i];
+
+  float after{block.counts->total()};
+
+  _last.deaths += before - after;
+
+  float infected{after - block.counts->healthy()};
+  float healthy_density{block.counts->healthy() / block.cell_count};
+  float spread{std::min(any_of_four(healthy_density) *
+    crowding_at(after / block.cell_count), 1.0f)};
+  float infections{std::min(block.counts->healthy(), infected * spread)};
+
+  infect(*block.counts, infections);
+  _last.infections += infections;
+
+  // the oldest bins are always empty after deaths so shifting loses none
+  for (int state{0}; state < 2; state++) {
+    float* first{counts.data() + state * Cohort::per_state};
+
+    std::copy_backward(first, first + Cohort::per_state - Cohort::per_age,
+      first + Cohort::per_state);
+
+    std::fill(first, first + Cohort::per_age, 0.0f);
+  }
+
+  for (int age{Rules::adult_age}; age < Cohort::ages; age++) {
+    for (int colour{0}; colour < Cohort::colours; colour++) {
+      _breedable_males += counts[Cohort::bin(false, age, BunnyColour(colour),
+        Gender::male)];
+    }
+  }
+}
+
+// migrants have already aged and been counted as males while agents, so
+// they join their cohort after its deaths and age shift
+void HybridWorld::add_arrivals() {
+  for (const auto& [index, bin] : _arrivals)
+    _blocks[index].counts->counts[bin] += 1;
+
+  _arrivals.clear();
+}
+
+// Bunnies on the edge of a block step across it with a quarter of the
+// chance that they move at all, so each side passes (1 - d^4) / 4 of its
+// edge row or column to the other, d being the density it steps into.
+void HybridWorld::exchange(int a, int b, bool horizontal) {
+  Block& first{_blocks[a]};
+  Block& second{_blocks[b]};
+
+  if (!first.cohort && !second.cohort)
+    return;
+
+  auto extent = [&](int index) {
+    return horizontal ?
+      std::min(block_size, _width - index % _blocks_x * block_size) :
+      std::min(block_size, _height - index / _blocks_x * block_size);
+  };
+
+  float first_rate{any_of_four(1 - _densities[b]) / 4 / extent(a)};
+  float second_rate{any_of_four(1 - _densities[a]) / 4 / extent(b)};
+
+  if (first.cohort && second.cohort) {
+    auto& from{first.counts->counts};
+    auto& to{second.counts->counts};
+
+    for (int i{0}; i < Cohort::bins; i++) {
+      float flow{from[i] * first_rate - to[i] * second_rate};
+
+      from[i] -= flow;
+      to[i] += flow;
+    }
+
+    return;
+  }
+
+  // crossings into an agent block are drawn as whole bunnies landing on
+  // the agent block's edge, if the cell they step onto is free
+  bool into_second{first.cohort};
+  Block& cohort_block{into_second ? first : second};
+  Cohort& cohort{*cohort_block.counts};
+  int agent_index{into_second ? b : a};
+  float rate{into_second ? first_rate : second_rate};
+  int crossings{stochastic_round(cohort.total() * rate)};
+
+  const int left{agent_index % _blocks_x * block_size};
+  const int top{agent_index / _blocks_x * block_size};
+  const int edge_length{horizontal ?
+    std::min(block_size, _height - top) : std::min(block_size, _width - left)
+  };
+
+  const int edge{into_second ? 0 :
+    (horizontal ? std::min(block_size, _width - left) :
+      std::min(block_size, _height - top)) - 1
+  };
+
+  for (int i{0}; i < crossings; i++) {
+    // bins with a whole bunny, picked in proportion to their counts
+    float whole{0};
+
+    for (const auto count : cohort.counts)
+      whole += count >= 1 ? count : 0;
+
+    if (whole <= 0)
+      break;
+
+    float pick{rnd_float() * whole};
+    int bin{0};
+
+    for (; bin < Cohort::bins - 1; bin++) {
+      if (cohort.counts[bin] < 1)
+        continue;
+
+      if (pick < cohort.counts[bin])
+        break;
+
+      pick -= cohort.counts[bin];
+    }
+
+    int along{util::rnd_range(0, edge_length - 1)};
+    sf::Vector2i pos{horizontal ?
+      sf::Vector2i(left + edge, top + along) :
+      sf::Vector2i(left + along, top + edge)
+    };
+
+    if (cell(pos) || cohort.counts[bin] < 1)
+      continue;
+
+    cohort.counts[bin] -= 1;
+    add_agent(agent_index, Bunny(pos, bin % Cohort::per_state /
+      Cohort::per_age, BunnyColour(bin % Cohort::per_age / Cohort::genders),
+      Gender(bin % Cohort::genders), bin >= Cohort::per_state));
+  }
+}
+
+// flows across every block edge with a cohort on either side, using the
+// densities from before any of them
+void HybridWorld::flow() {
+  for (int i{0}; i < (int)_blocks.size(); i++)
+    _densities[i] = density(_blocks[i]);
+
+  for (int i{0}; i < (int)_blocks.size(); i++) {
+    if (i % _blocks_x + 1 < _blocks_x)
+      exchange(i, i + 1, true);
+
+    if (i / _blocks_x + 1 < _blocks_y)
+      exchange(i, i + _blocks_x, false);
+  }
+}
+
+void HybridWorld::birth_agents(int index) {
+  const int mothers(_blocks[index].agents.size());
+
+  for (int i{0}; i < mothers; i++) {
+    // copied as births may grow the agents
+    const Bunny mother{_blocks[index].agents[i]};
+
+    if (mother.infected() || mother.age() < Rules::adult_age ||
+      mother.gender() != Gender::female)
+    {
+      continue;
+    }
+
+    for (const auto dir : rnd_dirs()) {
+      sf::Vector2i new_pos{path_finding::traverse(mother.pos, dir)};
+
+      if (!in_world(new_pos))
+        continue;
+
+      int to{block_index(new_pos)};
+      Block& block{_blocks[to]};
+
+      if (block.cohort) {
+        if (rnd_float() < density(block))
+          continue;
+
+        Bunny bunny(new_pos, 0, mother.colour(), Rules::mutant_chance);
+
+        block.counts->counts[bin_of(bunny)] += 1;
+        _last.births++;
+
+        break;
+      }
+
+      if (block.cells[local_cell(new_pos)])
+        continue;
+
+      Bunny bunny(new_pos, 0, mother.colour(), Rules::mutant_chance);
+
+      add_agent(to, bunny);
+      _last.births++;
+
+      if (bunny.infected())
+        mutate_adj(new_pos);
+
+      break;
+    }
+  }
+}
+
+// every breedable female gives birth if a neighbouring cell is free
+void HybridWorld::birth_cohort(Block& block) {
+  auto& counts{block.counts->counts};
+  float free_chance{any_of_four(1 - density(block))};
+  float infected_births{0};
+
+  for (int colour{0}; colour < Cohort::colours; colour++) {
+    float mothers{0};
+
+    for (int age{Rules::adult_age}; age < Cohort::ages; age++) {
+      mothers += counts[Cohort::bin(false, age, BunnyColour(colour),
+        Gender::female)];
+    }
+
+    float births{mothers * free_chance};
+    float infected{births / Rules::mutant_chance};
+
+    for (const auto gender : {Gender::male, Gender::female}) {
+      counts[Cohort::bin(false, 0, BunnyColour(colour), gender)] +=
+        (births - infected) / 2;
+
+      counts[Cohort::bin(true, 0, BunnyColour(colour), gender)] +=
+        infected / 2;
+    }
+
+    _last.births += births;
+    infected_births += infected;
+  }
+
+  // the healthy mother is always next to an infected newborn, so each one
+  // infects a bunny
+  float infections{std::min(block.counts->healthy(), infected_births)};
+
+  infect(*block.counts, infections);
+  _last.infections += infections;
+}
+
+// a shortage culls every bunny with the same chance, leaving half the limit
+// in expectation
+void HybridWorld::cull() {
+  double population{0};
+
+  for (const auto& block : _blocks)
+    population += block.cohort ? block.counts->total() : block.agents.size();
+
+  if (population <= _bunny_limit)
+    return;
+
+  float keep(_bunny_limit / 2 / population);
+
+  for (auto& block : _blocks) {
+    if (block.cohort) {
+      float before{block.counts->total()};
+
+      for (auto& count : block.counts->counts)
+        count *= keep;
+
+      _last.culls += before - block.counts->total();
+
+      continue;
+    }
+
+    std::size_t kept{0};
+
+    for (std::size_t i{0}; i < block.agents.size(); i++) {
+      if (rnd_float() < keep)
+        block.agents[kept++] = block.agents[i];
+    }
+
+    _last.culls += block.agents.size() - kept;
+
+    if (kept == block.agents.size())
+      continue;
+
+    block.agents.erase(block.agents.begin() + kept, block.agents.end());
+    rebuild_cells(block);
+  }
+}
+
+void HybridWorld::switch_blocks() {
+  for (auto& block : _blocks) {
+    if (!block.cohort && _resolution != Resolution::agents &&
+      block.agents.size() > cohort_density * block.cell_count)
+    {
+      to_cohort(block);
+    }
+
+    else if (block.cohort && _resolution == Resolution::adaptive &&
+      block.counts->total() < agent_density * block.cell_count)
+    {
+      to_agents(block);
+    }
+  }
+}
+
+void HybridWorld::count() {
+  _last.population = 0;
+  _last.infected = 0;
+  _last.agent_blocks = 0;
+  _last.cohort_blocks = 0;
+
+  for (const auto& block : _blocks) {
+    if (block.cohort) {
+      float total{block.counts->total()};
+
+      _last.population += total;
+      _last.infected += total - block.counts->healthy();
+      _last.cohort_blocks++;
+
+      continue;
+    }
+
+    _last.population += block.agents.size();
+    _last.agent_blocks += !block.agents.empty();
+
+    for (const auto& bunny : block.agents)
+      _last.infected += bunny.infected();
+  }
+}
+
+// a world with under half a bunny left in expectation has died out
+bool HybridWorld::next_turn() {
+  if (_total.population < 0.5)
+    return true;
+
+  _last = HybridStats{};
+  _last.turn = _total.turn + 1;
+  _breedable_males = 0;
+
+  for (int i{0}; i < (int)_blocks.size(); i++) {
+    if (!_blocks[i].cohort && !_blocks[i].agents.empty())
+      update_agents(i);
+  }
+
+  apply_migrations();
+
+  for (auto& block : _blocks) {
+    if (block.cohort)
+      update_cohort(block);
+  }
+
+  add_arrivals();
+  flow();
+
+  if (_breedable_males >= 0.5) {
+    for (int i{0}; i < (int)_blocks.size(); i++) {
+      if (_blocks[i].cohort)
+        birth_cohort(_blocks[i]);
+
+      else if (!_blocks[i].agents.empty())
+        birth_agents(i);
+    }
+  }
+
+  for (auto& block : _blocks) {
+    if (block.cohort || block.agents.size() < 2)
+      continue;
+
+    std::stable_sort(block.agents.begin(), block.agents.end(),
+      [](const Bunny& b1, const Bunny& b2) { return b1.age() < b2.age(); });
+
+    rebuild_cells(block);
+  }
+
+  cull();
+  switch_blocks();
+  count();
+
+  _total.turn = _last.turn;
+  _total.births += _last.births;
+  _total.deaths += _last.deaths;
+  _total.infections += _last.infections;
+  _total.culls += _last.culls;
+  _total.population = _last.population;
+  _total.infected = _last.infected;
+  _total.agent_blocks = _last.agent_blocks;
+  _total.cohort_blocks = _last.cohort_blocks;
+
+  return false;
+}
+
+void HybridWorld::reset() {
+  for (auto& block : _blocks) {
+    block.cohort = false;
+    block.agents.clear();
+    block.counts.reset();
+    block.cells.assign(block_size * block_size, 0);
+  }
+
+  for (int i{0}; i < _initial_spawn; i++) {
+    sf::Vector2i pos(util::rnd_range(0, _width - 1),
+      util::rnd_range(0, _height - 1));
+
+    if (!cell(pos)) {
+      add_agent(block_index(pos),
+        Bunny(pos, Rules::max_initial_age, Rules::mutant_chance));
+    }
+  }
+
+  for (auto& block : _blocks) {
+    std::stable_sort(block.agents.begin(), block.agents.end(),
+      [](const Bunny& b1, const Bunny& b2) { return b1.age() < b2.age(); });
+
+    rebuild_cells(block);
+
+    if (_resolution == Resolution::cohorts)
+      to_cohort(block);
+  }
+
+  _last = HybridStats{};
+  count();
+  _total = _last;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts calls to the global operator new when built with BUNNY_ALLOC_CHECK
+// (cmake -DBUNNY_ALLOC_CHECK=ON). Otherwise nothing is hooked and the count
+// stays at zero.
+namespace alloc_counter {
+  bool enabled();
+  std::uint64_t allocations();
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
+#pragma once
+
 #include <SFML/System/Vector2.hpp>
 #include <string_view>
+#include <cstdint>
 
 #include "util.hpp"
 
@@ -28,21 +31,32 @@ class Bunny {
   Gender _gender{};
   BunnyColour _colour{};
   int _age{};
-  std::string _name{}; // const
+  std::uint16_t _name{}; // index into bunny_names
   bool _mutant{};
+  int _hunger{}; // turns in a row without enough food
+  std::uint32_t _id{no_id}; // serial number given by the manager
 
 public:
+  static constexpr std::uint32_t no_id{0xffffffffu};
+
   sf::Vector2i pos{};
 
   int age() const;
   const Gender& gender() const;
   const BunnyColour& colour() const;
-  const std::string& name() const;
+  std::string_view name() const;
+  int name_index() const;
   bool infected() const;
+  int hunger() const;
+  std::uint32_t id() const;
 
-  explicit Bunny(sf::Vector2i bunny_pos);
-  Bunny(sf::Vector2i pos, int age, BunnyColour colour);
+  Bunny(sf::Vector2i bunny_pos, int max_age, int mutant_chance);
+  Bunny(sf::Vector2i pos, int age, BunnyColour colour, int mutant_chance);
+  Bunny(sf::Vector2i pos, int age, BunnyColour colour, Gender gender,
+    bool infected);
 
   void grow(int years);
   void infect();
+  void feed(bool enough);
+  void set_id(std::uint32_t id);
 };
\ No newline at end of file
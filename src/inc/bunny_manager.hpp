@@ -1,58 +1,132 @@
 #pragma once
 
 #include <SFML/System/Vector2.hpp>
-#include <list>
-#include <unordered_map>
+#include <SFML/Graphics/Rect.hpp>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <optional>
+#include <limits>
 
 #include "util.hpp"
 #include "bunny.hpp"
+#include "bunny_pool.hpp"
 #include "tile_map.hpp"
 #include "tile_type.hpp"
-#include "logger.hpp"
+#include "turn_events.hpp"
+#include "rules.hpp"
+#include "path_finding.hpp"
+#include "walk_map.hpp"
+#include "food_field.hpp"
+#include "spatial_index.hpp"
+#include "memory_usage.hpp"
 
 namespace bunny_manager {
-  typedef std::list<std::pair<sf::Vector2i, BunnyColour>> breedable_females_t;
+  typedef std::vector<BunnyHandle> breedable_females_t;
 }
 
-template<typename T>
-struct std::hash<sf::Vector2<T>> {
-  std::size_t operator()(const sf::Vector2<T>& k) const {
-    std::size_t seed{0};
+// Which bunnies an inspection matches; a field left unset matches any.
+struct BunnyFilter {
+  std::optional<BunnyColour> colour{};
+  std::optional<bool> infected{};
+  int min_age{0};
+  int max_age{std::numeric_limits<int>::max()};
 
-    util::hash_combine(seed, k.x);
-    util::hash_combine(seed, k.y);
-
-    return seed;
-  }
+  bool matches(const Bunny& bunny) const;
 };
 
-class BunnyManager {
-  static const int bunny_limit{1000};
-
-  std::list<Bunny> _bunnies{};
-  std::unordered_map<sf::Vector2i, Bunny&> _bunny_pos_map{};
+template<typename Rules>
+class BasicBunnyManager {
+  BunnyPool _bunnies{};
+  std::vector<BunnyHandle> _order{}; // iteration order, by age or position
+  std::vector<BunnyHandle> _order_scratch{}; // age order in spatial order
+  std::vector<std::uint64_t> _spatial_keys{};
+  int _hilbert_side{1};
+  std::vector<int> _age_counts{};
+  std::vector<BunnyHandle> _bunny_pos_map{}; // per cell, invalid if empty
+  bunny_manager::breedable_females_t _breedable_females{};
   TileMap& _tile_map;
-  Logger& _logger;
   TileType _floor_tile{};
+  std::vector<EventConsumer*> _consumers{};
+  bool _roster{};
+  bool _timed{};
+  std::chrono::steady_clock::time_point _phase_start{};
+  EventBatch _events{};
+  int _turn{};
+  std::uint32_t _next_id{}; // not reset so ids stay unique across resets
+  const WalkMap* _walk_map{};
   std::vector<bool> _cull_bunnies{};
+  path_finding::DistanceField _mate_field{};
+  std::vector<int> _mate_sources{};
+  std::vector<int> _route{}; // cells of the last foraging route
+  std::unique_ptr<FoodField> _food_field{};
+  SpatialIndex<BunnyHandle> _index{};
   
-  static std::string bunny_info(const Bunny& bunny);
-  static bool is_overaged(const Bunny& bunny);
+  static bool is_starved(const Bunny& bunny);
 
-  void print_bunny_born(const Bunny& bunny);
-  void print_bunny_died(const Bunny& bunny);
+  void emit(EventType type, BunnyHandle handle, const Bunny& bunny,
+    int floor = 0, sf::Vector2i from = {});
+  void lap(std::int64_t& phase); // records the time since the last lap
+  void publish();
   void spawn_initial(int amount);
-  void set_bunny_tile(const Bunny& bunny);
-  void move_bunny_adj(Bunny& bunny);
+  BunnyHandle add_bunny(const Bunny& bunny,
+    std::uint32_t mother = Bunny::no_id);
+  void remove_bunny(BunnyHandle handle, EventType type);
+  bool occupied(sf::Vector2i pos) const;
+  int cell_index(sf::Vector2i pos) const;
+  bool walkable(sf::Vector2i pos) const;
+  bool spawnable(sf::Vector2i pos) const;
+  int floor_tile_at(sf::Vector2i pos) const;
+  void move_bunny(BunnyHandle handle, sf::Vector2i new_pos);
+  void move_bunny_adj(BunnyHandle handle);
+  bool seek_mate(BunnyHandle handle);
+  bool forage(BunnyHandle handle);
   void mutate_adj(sf::Vector2i pos);
+  bool has_mate_near(sf::Vector2i pos) const;
   void birth_bunnies(bunny_manager::breedable_females_t& breedable_females);
-  void sort_by_age();
+  void sort_by_age(std::vector<BunnyHandle>& sorted);
+  void sort_spatially();
+  void cull_randomly(int keep);
   void food_shortage();
 
 public:
-  BunnyManager(TileMap& tile_map, TileType floor_tile,
-    Logger& logger);
+  // Consumers receive each turn's events once the turn has finished; the
+  // tile map is only painted by a TilePainter consumer. Without a walk map
+  // every in bounds cell is walkable.
+  BasicBunnyManager(TileMap& tile_map, TileType floor_tile,
+    std::vector<EventConsumer*> consumers,
+    const WalkMap* walk_map = nullptr);
+
+  int turn() const;
+
+  const FoodField* food_field() const;
+  const BunnyPool& bunnies() const;
+  const std::vector<BunnyHandle>& order() const;
+  const SpatialIndex<BunnyHandle>& index() const;
+
+  // Inspection between turns from the position map and, under rules that
+  // keep it, the spatial index, so a query visits the cells or buckets
+  // overlapping it rather than every bunny.
+  BunnyHandle bunny_at(sf::Vector2i pos) const; // invalid if none
+
+  // fills found with the matching bunnies inside rect in row order
+  void bunnies_in(sf::IntRect rect, const BunnyFilter& filter,
+    std::vector<BunnyHandle>& found) const;
 
+  // adds a line per buffer group to report
+  void report_memory(MemoryReport& report) const;
+
+  void add_consumer(EventConsumer& consumer);
   bool next_turn();
   void reset();
-};
\ No newline at end of file
+
+  // Culls at random down to keep bunnies between turns, publishing the
+  // culls as another batch of the current turn.
+  void cull(int keep);
+
+  // Gives back what the buffers hold beyond the current population. They
+  // grow again as needed, so turns may allocate until they have.
+  void compact();
+};
+
+typedef BasicBunnyManager<rules::Default> BunnyManager;
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "bunny.hpp"
+
+// 32 bit reference to a pooled bunny: the low index_bits select the slot
+// and the rest hold the slot's generation when the handle was issued. A
+// slot's generation changes each time it is freed so handles to a dead
+// bunny are detected rather than silently aliasing its replacement.
+// Generations wrap from 255 to 0, so a handle kept across 256 frees of its
+// slot aliases again. Slots stop below index_mask, so no handle is ever
+// the invalid all ones value.
+class BunnyHandle {
+  std::uint32_t _value{invalid_value};
+
+public:
+  static constexpr int index_bits{24};
+  static constexpr std::uint32_t index_mask{(1u << index_bits) - 1};
+  static constexpr std::uint32_t generation_mask{0xffffffffu >> index_bits};
+  static constexpr std::uint32_t invalid_value{0xffffffffu};
+
+  BunnyHandle() = default;
+
+  BunnyHandle(std::uint32_t index, std::uint32_t generation) :
+    _value(index | generation << index_bits) {}
+
+  std::uint32_t index() const { return _value & index_mask; }
+  std::uint32_t generation() const { return _value >> index_bits; }
+  std::uint32_t value() const { return _value; }
+  bool valid() const { return _value != invalid_value; }
+
+  bool operator==(const BunnyHandle& other) const = default;
+};
+
+// Slab of bunny records reused through a free list. Once the pool has grown
+// to the peak population, births and deaths are free list pops and pushes
+// and never touch the heap. Records may move when the slab grows, so keep
+// handles rather than references across births. create throws
+// std::length_error rather than hand out a slot past max_slots.
+class BunnyPool {
+public:
+  static constexpr std::uint32_t max_slots{BunnyHandle::index_mask};
+
+private:
+  std::vector<Bunny> _slots{};
+  std::vector<std::uint32_t> _generations{};
+  std::vector<std::uint32_t> _free{};
+  int _size{};
+
+public:
+  int size() const;
+  int capacity() const;
+  bool empty() const;
+  std::size_t memory_bytes() const;
+
+  void reserve(int count);
+  BunnyHandle create(const Bunny& bunny);
+  void destroy(BunnyHandle handle);
+  void clear();
+
+  // gives back the free slots at the end of the slab
+  void compact();
+
+  bool alive(BunnyHandle handle) const {
+    return handle.valid() && handle.index() < _generations.size() &&
+      _generations[handle.index()] == handle.generation();
+  }
+
+  // nullptr for stale handles
+  Bunny* get(BunnyHandle handle) {
+    return alive(handle) ? &_slots[handle.index()] : nullptr;
+  }
+
+  const Bunny* get(BunnyHandle handle) const {
+    return alive(handle) ? &_slots[handle.index()] : nullptr;
+  }
+
+  // unchecked access for handles known to be alive
+  Bunny& operator[](BunnyHandle handle) { return _slots[handle.index()]; }
+
+  const Bunny& operator[](BunnyHandle handle) const {
+    return _slots[handle.index()];
+  }
+};
\ No newline at end of file
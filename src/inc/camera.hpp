@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+// View onto the tile map: the world position (in cells) shown at the
+// centre of the screen and the zoom in screen pixels per cell.
+class Camera {
+  sf::Vector2i _world{};
+  sf::Vector2i _screen{};
+  sf::Vector2f _centre{};
+  float _zoom{1};
+
+  void clamp();
+
+public:
+  static constexpr float min_zoom{1.0f / 64};
+  static constexpr float max_zoom{64};
+
+  Camera(sf::Vector2i world, sf::Vector2i screen);
+
+  sf::Vector2i screen() const;
+  sf::Vector2f centre() const;
+  float zoom() const;
+
+  void resize(sf::Vector2i screen);
+  void fit(); // shows the whole world
+  void pan(sf::Vector2f screen_delta);
+
+  // keeps the world position under screen_pos where it is
+  void zoom_at(sf::Vector2i screen_pos, float factor);
+
+  sf::Vector2f to_world(sf::Vector2f screen_pos) const;
+  sf::FloatRect visible() const; // in cells
+};
\ No newline at end of file
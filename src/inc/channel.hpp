@@ -0,0 +1,138 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "shared_memory.hpp"
+
+// One end of an ordered, reliable byte stream between two processes.
+// send blocks while the stream is full and receive until every requested
+// byte has arrived, so messages are a fixed header followed by arrays whose
+// lengths the header gives. If the other end closes or the watched process
+// exits while waiting, the channel fails: from then on sends are dropped
+// and receives read zeros, so callers check failed between messages.
+class Channel {
+protected:
+  int _peer{}; // watched process, any_child or none
+  bool _failed{};
+
+public:
+  static constexpr int any_child{-1};
+
+  virtual ~Channel() = default;
+
+  virtual void send(const void* data, std::size_t size) = 0;
+  virtual void receive(void* data, std::size_t size) = 0;
+
+  // tells the other end that this one has gone
+  virtual void close() = 0;
+
+  // pid is the process whose exit fails a wait, or any_child for any child
+  // of this process
+  void watch(int pid) { _peer = pid; }
+  bool failed() const { return _failed; }
+
+  template<typename T>
+  void send_value(const T& value) { send(&value, sizeof(T)); }
+
+  template<typename T>
+  T receive_value() {
+    T value{};
+
+    receive(&value, sizeof(T));
+
+    return value;
+  }
+
+  template<typename T>
+  void send_array(const std::vector<T>& values) {
+    send(values.data(), values.size() * sizeof(T));
+  }
+
+  // resizes values to count, reusing its capacity
+  template<typename T>
+  void receive_array(std::vector<T>& values, std::size_t count) {
+    values.resize(count);
+    receive(values.data(), count * sizeof(T));
+  }
+};
+
+// Single producer, single consumer byte ring laid out in shared memory. The
+// head and tail are free running counters on separate cache lines; the
+// writer only stores the head and the reader only the tail, so no locks or
+// syscalls are needed. A full or empty ring is waited on by spinning, then
+// yielding; while yielding the wait gives up once either end has closed the
+// ring or the watched process has exited.
+class ShmRing {
+  struct Header {
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+    alignas(64) std::atomic<std::uint32_t> closed;
+  };
+
+  Header* _header{};
+  std::uint8_t* _data{};
+  std::size_t _capacity{};
+
+public:
+  // capacity is rounded up to a power of two
+  static std::size_t round_capacity(std::size_t capacity);
+  static std::size_t bytes_needed(std::size_t capacity);
+
+  ShmRing() = default;
+  ShmRing(void* memory, std::size_t capacity);
+
+  // false if the ring was closed or peer exited before it could finish
+  bool write(const void* data, std::size_t size, int peer);
+  bool read(void* data, std::size_t size, int peer);
+  void close();
+};
+
+// Both directions of a link between two processes on one host: a ring for
+// each way in shared memory mapped before the fork.
+class RingChannel : public Channel {
+  ShmRing _out{};
+  ShmRing _in{};
+
+public:
+  RingChannel(ShmRing out, ShmRing in);
+
+  void send(const void* data, std::size_t size) override;
+  void receive(void* data, std::size_t size) override;
+  void close() override;
+};
+
+// A Unix stream socket, standing in for a network transport between hosts.
+class SocketChannel : public Channel {
+  int _fd{-1};
+
+public:
+  explicit SocketChannel(int fd);
+  ~SocketChannel();
+
+  SocketChannel(const SocketChannel&) = delete;
+  SocketChannel& operator=(const SocketChannel&) = delete;
+
+  void send(const void* data, std::size_t size) override;
+  void receive(void* data, std::size_t size) override;
+  void close() override;
+};
+
+enum class Transport {
+  shm,
+  socket
+};
+
+// The two ends of a link, made before forking; each process keeps the end
+// it was given. Ring links are carved out of memory, which must stay
+// mapped and hold bytes_needed for both rings.
+struct Link {
+  std::unique_ptr<Channel> ends[2]{};
+
+  static std::size_t ring_bytes(std::size_t capacity);
+  static Link rings(void* memory, std::size_t capacity);
+  static Link socket(std::size_t buffer);
+};
\ No newline at end of file
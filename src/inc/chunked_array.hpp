@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Append-only array stored in fixed size chunks. Growing never copies the
+// existing elements, so very long arrays avoid the doubling spike of a
+// vector and elements keep their address.
+template<typename T, int chunk_bits = 20>
+class ChunkedArray {
+  static constexpr std::size_t chunk_size{std::size_t(1) << chunk_bits};
+  static constexpr std::size_t chunk_mask{chunk_size - 1};
+
+  std::vector<std::unique_ptr<T[]>> _chunks{};
+  std::size_t _size{};
+
+public:
+  std::size_t size() const { return _size; }
+
+  std::size_t memory_bytes() const {
+    return _chunks.size() * chunk_size * sizeof(T);
+  }
+
+  void push_back(const T& value) {
+    if ((_size & chunk_mask) == 0 && (_size >> chunk_bits) == _chunks.size())
+      _chunks.push_back(std::make_unique<T[]>(chunk_size));
+
+    (*this)[_size++] = value;
+  }
+
+  // keeps the chunks for reuse
+  void clear() { _size = 0; }
+
+  T& operator[](std::size_t i) {
+    return _chunks[i >> chunk_bits][i & chunk_mask];
+  }
+
+  const T& operator[](std::size_t i) const {
+    return _chunks[i >> chunk_bits][i & chunk_mask];
+  }
+};
\ No newline at end of file
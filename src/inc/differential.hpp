@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <cstdint>
+
+// Runs ReferenceManager and BasicBunnyManager<rules::Classic> side by side
+// from the same seed, each on its own tile map and random engine, and
+// compares the tile maps, populations and event streams after every turn.
+// Extinctions reset both engines and keep going.
+namespace differential {
+  struct Case {
+    std::uint32_t seed{};
+    int size{80};
+    bool rooms{};
+    int turns{300};
+  };
+
+  // reports the first divergence with context to out; true if none
+  bool run(const Case& test_case, std::ostream& out);
+
+  // runs every seed against every size, open and with rooms, stopping at
+  // the first case that diverges; nonzero if one did
+  int stress(const std::vector<std::uint32_t>& seeds,
+    const std::vector<int>& sizes, int turns, std::ostream& out);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "shared_memory.hpp"
+#include "channel.hpp"
+#include "event_consumers.hpp"
+#include "strip_worker.hpp"
+
+// Splits a width by height world into horizontal strips and forks a
+// StripWorker process for each, so large worlds are stepped by several
+// processes with their own memory rather than one bandwidth bound process.
+// Workers talk to the coordinator and their neighbours over links made
+// before the fork: rings in one shared mapping, or sockets standing in for
+// a transport between hosts. The coordinator sums the per strip stats and
+// makes the world wide decisions: whether any male can breed, and how many
+// bunnies each strip culls in a food shortage.
+class DomainCoordinator {
+  int _width{};
+  int _height{};
+  int _bunny_limit{};
+  int _initial_spawn{};
+  std::vector<int> _row_begins{}; // per worker, then the height
+  SharedMemory _memory{};
+  std::vector<Link> _links{}; // per worker, then between neighbours
+  std::vector<int> _pids{};
+  std::vector<TurnStats> _reports{};
+  std::vector<bool> _cull_bunnies{};
+  TurnStats _last{};
+  TurnStats _total{};
+
+  Channel& worker(int index);
+  void broadcast(domain::CommandType type, int value = 0);
+
+public:
+  // workers is clamped to the number of rows; bunny_limit triggers a
+  // shortage cull as in the classic rules
+  DomainCoordinator(int width, int height, int workers, Transport transport,
+    int bunny_limit, int initial_spawn);
+  ~DomainCoordinator(); // stops and reaps the workers
+
+  DomainCoordinator(const DomainCoordinator&) = delete;
+  DomainCoordinator& operator=(const DomainCoordinator&) = delete;
+
+  bool started() const; // false if the links or a fork failed
+  bool failed() const; // a worker has exited or closed its link
+  int workers() const;
+  const TurnStats& last() const;
+  const TurnStats& total() const; // population is the current population
+
+  // true once every bunny has died, as with BunnyManager, or on failure
+  bool next_turn();
+  void reset();
+};
\ No newline at end of file
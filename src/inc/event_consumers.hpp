@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "turn_events.hpp"
+#include "tile_map.hpp"
+#include "tile_type.hpp"
+#include "logger.hpp"
+#include "telemetry.hpp"
+
+// Paints bunny sprites and the floor they leave behind onto the tile map.
+class TilePainter : public EventConsumer {
+  TileMap& _tile_map;
+
+public:
+  static TileType bunny_tile(const TurnEvent& event);
+
+  explicit TilePainter(TileMap& tile_map);
+
+  void consume(const EventBatch& batch) override;
+};
+
+// Writes the births, deaths, shortages and roster as the original text log.
+class TextLogger : public EventConsumer {
+  Logger& _logger;
+  bool _roster{};
+  std::string _line{};
+
+  void log_bunny(const TurnEvent& event, std::string_view what);
+
+public:
+  explicit TextLogger(Logger& logger, bool roster = true);
+
+  void consume(const EventBatch& batch) override;
+  bool wants_roster() const override;
+};
+
+struct TurnStats {
+  int turn{};
+  int population{};
+  int births{};
+  int deaths{};
+  int infections{};
+  int culls{};
+  int moves{};
+};
+
+class StatsCollector : public EventConsumer {
+  TurnStats _last{};
+  TurnStats _total{};
+
+public:
+  const TurnStats& last() const;
+  const TurnStats& total() const; // population is the current population
+
+  void consume(const EventBatch& batch) override;
+};
+
+// Appends each batch as a turn number, event count and the raw events so a
+// run can be replayed or analysed later.
+class EventRecorder : public EventConsumer {
+  std::ofstream _ofs{};
+
+public:
+  explicit EventRecorder(std::string_view file_name);
+
+  void consume(const EventBatch& batch) override;
+};
+
+// Hands batches to another consumer on a worker thread. consume copies the
+// batch into a reused buffer and only blocks if the worker is still busy
+// with the previous turn.
+class AsyncConsumer : public EventConsumer {
+  EventConsumer& _inner;
+  EventBatch _pending{};
+  EventBatch _working{};
+  bool _has_pending{};
+  bool _busy{};
+  bool _stop{};
+  std::mutex _mutex{};
+  std::condition_variable _cv{};
+  std::thread _worker{};
+
+  void run();
+
+public:
+  explicit AsyncConsumer(EventConsumer& inner);
+  ~AsyncConsumer();
+
+  void consume(const EventBatch& batch) override;
+  bool wants_roster() const override;
+  bool wants_timings() const override;
+
+  // waits until every batch handed over so far has been consumed
+  void flush();
+};
+
+// Publishes a record per turn, built from the batch and its phase timings,
+// to a telemetry ring.
+class TelemetryPublisher : public EventConsumer {
+  TelemetryWriter& _writer;
+  StatsCollector _stats{};
+  int _infected{};
+
+public:
+  explicit TelemetryPublisher(TelemetryWriter& writer);
+
+  void consume(const EventBatch& batch) override;
+  bool wants_timings() const override;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+
+#include "walk_map.hpp"
+#include "thread_pool.hpp"
+
+// Per cell food stored as one byte per cell. Each update regrows every cell
+// and diffuses it towards its four neighbours with a 5 point stencil, run
+// over cache sized blocks of the grid and optionally across threads. A full
+// block next to full blocks stays full, so blocks nobody has eaten from are
+// skipped once both buffers hold them full.
+class FoodField {
+  int _width{};
+  int _height{};
+  std::vector<std::uint8_t> _food{};
+  std::vector<std::uint8_t> _next{};
+  std::vector<std::uint8_t> _mask{}; // 0 on walls so they never hold food
+  std::uint8_t _regrow{};
+  int _strips{}; // blocks across
+  std::vector<std::uint8_t> _full_turns{}; // per block, up to 2
+  std::vector<std::uint8_t> _skip{}; // per block, for this update
+  std::unique_ptr<ThreadPool> _pool{};
+
+  int block_of(int cell) const {
+    return cell / _width / block_rows * _strips + cell % _width / block_cols;
+  }
+
+  bool settled(int block_row, int block_col) const;
+  void update_block(int block);
+
+public:
+  static constexpr std::uint8_t max_food{255};
+  static constexpr int block_rows{16};
+  static constexpr int block_cols{256}; // bytes per row kept in cache
+
+  int width() const;
+  int height() const;
+  const std::vector<std::uint8_t>& data() const;
+  std::size_t memory_bytes() const;
+
+  // threads of 1 updates on the calling thread only
+  FoodField(int width, int height, std::uint8_t regrow, int threads = 1,
+    const WalkMap* walk_map = nullptr);
+
+  void fill(std::uint8_t food);
+  void update();
+
+  std::uint8_t food(int cell) const { return _food[cell]; }
+
+  // removes up to amount from cell and returns how much was eaten
+  int consume(int cell, int amount) {
+    int eaten{std::min<int>(amount, _food[cell])};
+
+    _food[cell] -= eaten;
+
+    if (eaten)
+      _full_turns[block_of(cell)] = 0;
+
+    return eaten;
+  }
+};
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "tile_map.hpp"
+#include "tile_raster.hpp"
+#include "thread_pool.hpp"
+
+enum class FrameFormat {
+  png,
+  ppm // binary P6, raw RGB
+};
+
+// Writes tile map snapshots as numbered images (frame_000000.png, ...).
+// capture only copies the tile types and returns; rasterising and encoding
+// happen on the pool so the simulation keeps advancing while earlier frames
+// are written. At most two frames per worker are in flight and capture
+// blocks while all of them are busy.
+class FrameExporter {
+  struct Frame {
+    int number{};
+    std::vector<std::uint8_t> cells{};
+    std::vector<std::uint8_t> pixels{};
+  };
+
+  const TileRaster& _raster;
+  std::string _dir{};
+  FrameFormat _format{};
+  int _width{};
+  int _height{};
+  std::vector<Frame> _frames{};
+  std::vector<int> _free{};
+  std::mutex _mutex{};
+  std::condition_variable _free_cv{};
+  std::atomic<int> _failed{};
+  ThreadPool _pool; // last so its workers stop before the frames go
+
+  bool write(Frame& frame) const;
+  void encode(int slot);
+
+public:
+  FrameExporter(const TileRaster& raster, int width, int height,
+    std::string_view dir, FrameFormat format, int threads = 0);
+
+  int failed() const; // frames that could not be written
+
+  void capture(const TileMap& tile_map, int number);
+  void finish(); // waits for every captured frame to be written
+};
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "turn_events.hpp"
+#include "chunked_array.hpp"
+
+// Family tree built from born events. Ids are handed out in birth order, so
+// each birth appends its mother's id and founder line to chunked arrays
+// indexed by id, and a mother's id is always smaller than her children's.
+// That is about six bytes and a bit per birth and nothing is ever moved, so
+// recording stays a few appends per birth. Initial bunnies (no mother)
+// each start a founder line that their descendants inherit.
+class Genealogy : public EventConsumer {
+public:
+  struct Descendants {
+    std::uint64_t total{};
+    std::uint64_t infected{};
+  };
+
+  static constexpr int no_line{-1};
+
+private:
+  std::uint32_t _first_id{Bunny::no_id};
+  ChunkedArray<std::uint32_t> _mothers{};
+  ChunkedArray<std::uint16_t> _lines{};
+  ChunkedArray<std::uint64_t, 14> _infected{}; // one bit per birth
+  std::vector<std::uint32_t> _founders{}; // founder id of each line
+  std::vector<int> _line_population{}; // living bunnies in each line
+  int _population{};
+  std::vector<std::uint64_t> _marks{}; // descendant bits for descendants()
+
+  std::size_t index(std::uint32_t id) const;
+  void set_infected(std::size_t i);
+  void add_birth(const TurnEvent& event);
+  void end_life(const TurnEvent& event);
+
+public:
+  static constexpr int max_lines{0xffff};
+
+  std::size_t births() const;
+  std::size_t memory_bytes() const;
+
+  bool known(std::uint32_t id) const;
+  std::uint32_t mother(std::uint32_t id) const; // Bunny::no_id for founders
+  bool infected(std::uint32_t id) const; // at birth or since
+  int line(std::uint32_t id) const;
+
+  int lines() const;
+  std::uint32_t founder(int line) const;
+  int population() const;
+  int line_population(int line) const;
+  double line_share(int line) const; // of the living population
+  int dominant_line() const; // no_line when extinct
+
+  // calls fn(id) for the mother, her mother and so on back to the founder
+  template<typename F>
+  void for_each_ancestor(std::uint32_t id, F&& fn) const {
+    while (known(id) && (id = mother(id)) != Bunny::no_id)
+      fn(id);
+  }
+
+  // Every bunny descended from id, found in one pass over the later
+  // births as a descendant's mother must be id or another descendant.
+  Descendants descendants(std::uint32_t id);
+
+  // descendant count of every birth, indexed like the births from the
+  // first id seen, in one backwards pass
+  void descendant_counts(std::vector<std::uint32_t>& counts) const;
+
+  void consume(const EventBatch& batch) override;
+};
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <array>
+#include <memory>
+#include <cstdint>
+#include <utility>
+
+#include "bunny.hpp"
+#include "rules.hpp"
+
+// Expected bunny counts of one block by infection, age, colour and gender.
+// Counts are fractional so the aggregate rules apply expected values
+// exactly. Every healthy bin comes before every infected one, and ages are
+// contiguous within each, so each rule is a loop over flat float arrays
+// that the compiler vectorises.
+struct Cohort {
+  static constexpr int genders{(int)Gender::end};
+  static constexpr int colours{(int)BunnyColour::end};
+  static constexpr int ages{rules::Classic::max_lifespan + 1};
+  static constexpr int per_age{colours * genders};
+  static constexpr int per_state{ages * per_age};
+  static constexpr int bins{per_state * 2};
+
+  alignas(32) std::array<float, bins> counts{};
+
+  static constexpr int bin(bool infected, int age, BunnyColour colour,
+    Gender gender)
+  {
+    return infected * per_state + age * per_age +
+      (int)colour * genders + (int)gender;
+  }
+
+  float total() const;
+  float healthy() const;
+};
+
+struct HybridStats {
+  int turn{};
+  double population{};
+  double infected{};
+  double births{};
+  double deaths{};
+  double infections{};
+  double culls{};
+  int agent_blocks{}; // blocks with at least one agent
+  int cohort_blocks{};
+};
+
+// How blocks are represented: switched by density, or pinned to one
+// representation to compare the two.
+enum class Resolution {
+  adaptive,
+  agents,
+  cohorts
+};
+
+// The classic rules over a world of block_size square blocks, each holding
+// either individual bunnies (agents) or a Cohort of expected counts. Agent
+// blocks follow the per bunny rules. Cohort blocks treat each block as well
+// mixed and apply an approximation of them in expectation:
+//
+// - the chance of dying at each age from the uniform lifespans;
+// - infecting a neighbour with the chance that one of four adjacent cells
+//   holds a healthy bunny, raised in sparse blocks where bunnies crowd
+//   round their mothers; an infected newborn always infects one;
+// - giving birth with the chance that one of four adjacent cells is free;
+// - moving across each edge at the rate a random walk crosses it.
+//
+// Breeding needs a breedable male anywhere, and a shortage culls every
+// bunny with the same chance. Blocks denser than cohort_density become
+// cohorts, and cohorts thinner than agent_density are drawn back out as
+// agents. Where a cohort meets an agent block, the expected crossings are
+// drawn as whole bunnies, and an agent infecting into a cohort does so with
+// its healthy density as the chance.
+class HybridWorld {
+public:
+  static constexpr int block_size{32};
+  static constexpr float cohort_density{0.25f};
+  static constexpr float agent_density{0.125f};
+
+private:
+  struct Block {
+    bool cohort{};
+    int cell_count{}; // cells inside the world
+    std::vector<Bunny> agents{}; // sorted by age between turns
+    std::vector<std::uint16_t> cells{}; // agent index + 1, 0 if empty
+    std::unique_ptr<Cohort> counts{};
+  };
+
+  struct Migration {
+    int from{};
+    int agent{};
+    int to{};
+    sf::Vector2i pos{};
+  };
+
+  int _width{};
+  int _height{};
+  int _blocks_x{};
+  int _blocks_y{};
+  int _bunny_limit{};
+  int _initial_spawn{};
+  Resolution _resolution{};
+  std::vector<Block> _blocks{};
+  std::vector<std::vector<std::uint8_t>> _gone{}; // per block and agent
+  std::vector<Migration> _migrations{};
+  std::vector<std::pair<int, int>> _arrivals{}; // cohort block and bin
+  std::vector<float> _densities{};
+  double _breedable_males{};
+  HybridStats _last{};
+  HybridStats _total{};
+
+  int block_index(sf::Vector2i pos) const;
+  int local_cell(sf::Vector2i pos) const;
+  bool in_world(sf::Vector2i pos) const;
+  float density(const Block& block) const;
+  float healthy_density(const Block& block) const;
+  std::uint16_t& cell(sf::Vector2i pos);
+
+  void add_agent(int block, const Bunny& bunny);
+  void rebuild_cells(Block& block);
+  void to_cohort(Block& block);
+  void to_agents(Block& block);
+  bool place_agent(int block, const Bunny& bunny, int tries);
+  bool infect_cohort(Block& block, float chance);
+  void mutate_adj(sf::Vector2i pos);
+
+  void update_agents(int index);
+  void apply_migrations();
+  void update_cohort(Block& block);
+  void add_arrivals();
+  void exchange(int a, int b, bool horizontal);
+  void flow();
+  void birth_agents(int index);
+  void birth_cohort(Block& block);
+  void cull();
+  void switch_blocks();
+  void count();
+
+public:
+  HybridWorld(int width, int height, int bunny_limit, int initial_spawn,
+    Resolution resolution = Resolution::adaptive);
+
+  const HybridStats& last() const;
+  const HybridStats& total() const; // population is the current population
+
+  bool next_turn(); // true once every bunny has died, as with BunnyManager
+  void reset();
+};
\ No newline at end of file
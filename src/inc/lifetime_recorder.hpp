@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string_view>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "turn_events.hpp"
+
+enum class DeathCause : std::uint8_t {
+  alive, // still alive when the recorder finished
+  age,
+  starved,
+  culled,
+  removed // cleared by a reset
+};
+
+// Builds one record per bunny lifetime (birth and death turn, cause, colour,
+// gender, infected-at turn, birth position and mother) from the events.
+// Living bunnies are tracked by pool slot; finished records go into
+// columnar blocks which are written out once block_rows are full, so memory
+// stays bounded by the live population plus one block however many
+// lifetimes a run produces.
+//
+// The columnar file starts with the magic "BUNNYLT1", a u32 column count
+// and for each column a type byte ('I' i32, 'U' u32, 'B' u8), a name length
+// byte and the name. Blocks follow until the end of the file, each a u32
+// row count and then every column's values for those rows in order.
+class LifetimeRecorder : public EventConsumer {
+public:
+  enum class Format {
+    columnar,
+    csv
+  };
+
+  static constexpr int block_rows{1 << 16};
+
+private:
+  struct Live {
+    bool alive{};
+    std::uint8_t colour{};
+    std::uint8_t gender{};
+    std::uint32_t id{};
+    std::uint32_t mother{};
+    std::int32_t birth_turn{};
+    std::int32_t infected_turn{};
+    sf::Vector2i birth_pos{};
+  };
+
+  struct Block {
+    std::vector<std::uint32_t> id{};
+    std::vector<std::uint32_t> mother{};
+    std::vector<std::int32_t> birth_turn{};
+    std::vector<std::int32_t> death_turn{};
+    std::vector<std::uint8_t> cause{};
+    std::vector<std::uint8_t> colour{};
+    std::vector<std::uint8_t> gender{};
+    std::vector<std::int32_t> infected_turn{};
+    std::vector<std::int32_t> birth_x{};
+    std::vector<std::int32_t> birth_y{};
+
+    int size() const { return id.size(); }
+  };
+
+  std::ofstream _ofs{};
+  Format _format{};
+  std::vector<Live> _live{}; // by pool slot
+  Block _block{};
+  std::string _line{};
+  std::uint64_t _rows{};
+  int _turn{};
+  bool _finished{};
+
+  void write_header();
+  void write_columnar();
+  void write_csv();
+  void end_life(const TurnEvent& event, DeathCause cause, int turn);
+  void add_row(const Live& live, DeathCause cause, int turn);
+  void flush();
+
+public:
+  explicit LifetimeRecorder(std::string_view file_name,
+    Format format = Format::columnar);
+  ~LifetimeRecorder();
+
+  std::uint64_t rows() const; // records written or waiting in the block
+
+  void consume(const EventBatch& batch) override;
+
+  // records the bunnies still alive and writes the last block
+  void finish();
+};
\ No newline at end of file
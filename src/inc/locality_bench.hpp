@@ -0,0 +1,12 @@
+#pragma once
+
+#include <ostream>
+
+// Steps a crowded world twice from the same seed, once updating bunnies by
+// age (rules::Crowded) and once along a Hilbert curve (rules::Local), and
+// compares the time and hardware misses per bunny update. Each world is
+// first grown to fill an eighth of its cells so the turns measured are the
+// large populations the order is for.
+namespace locality_bench {
+  int run(int size, int turns, std::ostream& out);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Naming, compression and lookup of the segments a rotating Logger writes.
+// output.txt becomes output.000000.txt, output.000001.txt and so on, each
+// compressed once closed, and output.idx holds a "turn segment offset" line
+// for where every turn starts, the offset counting uncompressed bytes.
+namespace log_segments {
+  std::string segment_path(std::string_view file_name, int segment);
+  std::string index_path(std::string_view file_name);
+
+  // deletes every segment and the index
+  void remove_all(std::string_view file_name);
+
+  // replaces a closed segment with a compressed copy, with zlib when built
+  // with it and lz otherwise; on failure the segment is left as it is
+  bool compress(const std::string& path);
+
+  // appends the lines logged in turn to out, decompressing only the
+  // segment holding them; false if the turn is not in the index
+  bool read_turn(std::string_view file_name, int turn, std::string& out);
+}
\ No newline at end of file
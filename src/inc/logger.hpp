@@ -3,16 +3,59 @@
 #include <string>
 #include <string_view>
 #include <fstream>
+#include <memory>
+#include <vector>
+#include <cstdint>
 
+#include "thread_pool.hpp"
+
+// Rotation of a Logger into segments; a limit of 0 is not applied, and
+// with neither the log is one file as before
+struct SegmentOptions {
+  std::int64_t max_bytes{};
+  int max_turns{};
+  int compress_threads{0}; // every hardware thread
+
+  bool enabled() const { return max_bytes > 0 || max_turns > 0; }
+};
+
+// Streams write through buffers the logger owns, so their size is known.
 class Logger {
   std::string _file_name{};
+  std::vector<char> _buffer{};
+  std::vector<char> _index_buffer{};
   std::ofstream _ofs{};
+  SegmentOptions _segments{};
+  int _segment{};
+  int _turn{-1}; // last begun, so a second batch of a turn is not indexed
+  int _segment_turns{};
+  std::int64_t _segment_bytes{};
+  std::ofstream _index{};
+  std::unique_ptr<ThreadPool> _compressors{};
+
+  static void open(std::ofstream& ofs, std::vector<char>& buffer,
+    const std::string& path);
+
+  void open_segments();
+  void close_segment();
 
 public:
+  static constexpr std::size_t buffer_size{1 << 16};
+
   bool to_console{};
 
-  Logger(std::string_view file_name, bool to_console = false);
+  Logger(std::string_view file_name, bool to_console = false,
+    SegmentOptions segments = {});
+
+  ~Logger();
+
+  std::size_t memory_bytes() const;
 
   void log(std::string_view str);
+
+  // marks where a turn's lines start in the index, first closing the open
+  // segment if it is full; only segmented logs use it
+  void begin_turn(int turn);
+
   void clear();
 };
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Small LZ77 codec for when zlib is not available. A stream is a run of
+// sequences, each a token byte holding the literal and match lengths, the
+// literals, then a 16 bit offset back to the match. Lengths of 15 or more
+// continue in following bytes. Matches are found through a hash table of
+// the last position of every 4 byte prefix, which suits repetitive text
+// such as the log.
+namespace lz {
+  // appends the compressed input to out
+  void compress(std::string_view input, std::string& out);
+
+  // appends the original input to out; false if the stream is corrupt
+  bool decompress(std::string_view input, std::string& out);
+}
\ No newline at end of file
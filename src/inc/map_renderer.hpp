@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+
+#include "tile_map.hpp"
+#include "tile_raster.hpp"
+#include "camera.hpp"
+
+// Draws the part of the tile map the camera can see into a screen sized
+// pixel buffer, so a frame costs the same however large the map is. When
+// zoomed in each pixel samples a tile image; when a cell is smaller than a
+// pixel it samples a level of detail where each cell stands for a block of
+// map cells and holds the block's most notable tile (bunnies over walls
+// over grass over the floor) drawn as that tile's average colour.
+//
+// While the camera stays put only the chunks of the screen covering
+// modified tiles are rasterised again and uploaded to the texture.
+class MapRenderer {
+public:
+  static constexpr int chunk_px{64};
+
+private:
+  TileRaster _raster{};
+  std::vector<std::vector<std::uint8_t>> _levels{}; // level 0 is the map
+  std::vector<sf::Vector2i> _level_sizes{};
+  std::vector<std::uint8_t> _pixels{}; // RGBA
+  std::vector<int> _col_cells{};
+  std::vector<int> _col_px{};
+  sf::Vector2i _screen{};
+  sf::Texture _texture{};
+  sf::Sprite _sprite{};
+
+  // view the pixel buffer was last drawn for
+  bool _drawn{};
+  sf::Vector2f _origin{};
+  float _zoom{};
+  int _level{};
+
+  sf::Vector2i _chunks{};
+  std::vector<std::uint8_t> _dirty_chunks{};
+  bool _any_dirty{};
+  std::vector<std::uint8_t> _upload{}; // contiguous copy of a dirty span
+
+  std::uint8_t merge(int level, int c, int r) const;
+  void rebuild(const TileMap& tile_map);
+  void propagate(int c, int r);
+  void mark_cell(int c, int r);
+  void set_view(const Camera& camera);
+  void draw_rect(int x0, int y0, int x1, int y1);
+  void upload_rect(int x0, int y0, int x1, int y1);
+
+public:
+  // tile_px is the resolution tile images are sampled at
+  bool load(int tile_px, TileType floor_tile);
+  void resize(sf::Vector2i screen);
+
+  // applies the map's modified tiles and resets them
+  void sync(TileMap& tile_map);
+
+  // true if the next render would change the texture for this camera
+  bool dirty(const Camera& camera) const;
+  void render(const Camera& camera);
+
+  const sf::Sprite& sprite() const;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// Memory is accounted from container capacities rather than by hooking the
+// allocator, so it costs nothing until a report is asked for and counts
+// what each subsystem holds, including slack it has not used yet.
+namespace memory_usage {
+  template<typename T>
+  std::size_t bytes(const std::vector<T>& vector) {
+    return vector.capacity() * sizeof(T);
+  }
+
+  template<typename T>
+  std::size_t bytes(const std::vector<std::vector<T>>& vectors) {
+    std::size_t total{vectors.capacity() * sizeof(std::vector<T>)};
+
+    for (const auto& vector : vectors)
+      total += bytes(vector);
+
+    return total;
+  }
+
+  // the whole process as the kernel sees it, 0 where it cannot be read
+  std::size_t resident_bytes();
+}
+
+// Bytes per subsystem, listed in the order they were added.
+class MemoryReport {
+public:
+  struct Entry {
+    std::string_view name{};
+    std::size_t bytes{};
+  };
+
+private:
+  std::vector<Entry> _entries{};
+
+public:
+  const std::vector<Entry>& entries() const;
+  std::size_t total() const;
+
+  void add(std::string_view name, std::size_t bytes);
+  void clear();
+  void print(std::ostream& out) const;
+};
+
+enum class MemoryPolicy {
+  cull, // half the bunnies, then compact
+  compact, // give back slack, and abort if still over
+  abort // stop the run with a report
+};
+
+// Decides when the accounted total calls for the policy. The total counts
+// capacities, so a cull is only felt once the freed space is compacted; a
+// run still over after the policy stops with a report.
+class MemoryBudget {
+  std::size_t _max_bytes{};
+  MemoryPolicy _policy{};
+
+public:
+  MemoryBudget() = default;
+  MemoryBudget(std::size_t max_bytes, MemoryPolicy policy);
+
+  bool enabled() const;
+  MemoryPolicy policy() const;
+  bool over(std::size_t total) const;
+};
\ No newline at end of file
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <utility>
-#include <string_view>
-#include <string>
-#include <functional>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cstdlib>
 
+// Grid searches operate on flat cell indices (r * width + c) so no
+// coordinate pairs, strings or node sets are allocated while searching.
+// Walkability is a functor taking a cell index, inlined into the search.
 namespace path_finding {
   enum class Dir {
     left,
@@ -13,11 +17,275 @@ namespace path_finding {
     down
   };
 
-  std::pair<int, int> traverse(std::pair<int, int> start, Dir dir);
-  
-  // std::pair<int, int> traverse(std::pair<int, int> start,
-  //   std::string_view path);
+  constexpr int no_cell{-1};
+  constexpr int unreachable{-1};
 
-  // std::pair<bool, std::string> bfs(std::pair<int, int> start,
-  //   std::pair<int, int> goal, std::function<bool(int, int)> valid_move);
+  // Returns the position one step from start in dir. Pos is any type with
+  // x and y members so callers keep their own coordinate type.
+  template<typename Pos>
+  constexpr Pos traverse(Pos start, Dir dir) {
+    switch (dir) {
+      case Dir::left:
+        start.x -= 1;
+
+        break;
+
+      case Dir::right:
+        start.x += 1;
+
+        break;
+
+      case Dir::up:
+        start.y -= 1;
+
+        break;
+
+      case Dir::down:
+        start.y += 1;
+
+        break;
+    }
+
+    return start;
+  }
+
+  // Returns the neighbouring index of cell in dir or no_cell if it leaves
+  // the grid.
+  inline int step(int cell, Dir dir, int width, int height) {
+    int c{cell % width};
+    int r{cell / width};
+
+    switch (dir) {
+      case Dir::left:
+        return c > 0 ? cell - 1 : no_cell;
+
+      case Dir::right:
+        return c < width - 1 ? cell + 1 : no_cell;
+
+      case Dir::up:
+        return r > 0 ? cell - width : no_cell;
+
+      case Dir::down:
+        return r < height - 1 ? cell + width : no_cell;
+    }
+
+    return no_cell;
+  }
+
+  // Buffers reused between searches. A cell is visited in the current
+  // search when its stamp equals generation, so starting a new search is a
+  // single increment rather than clearing every array.
+  struct Scratch {
+    std::vector<std::uint32_t> stamp{};
+    std::vector<int> parent{};
+    std::vector<int> cost{};
+    std::vector<int> queue{};
+    std::vector<std::pair<int, int>> heap{};
+    std::uint32_t generation{0};
+
+    void prepare(int cells);
+
+    bool visited(int cell) const { return stamp[cell] == generation; }
+
+    void visit(int cell, int from, int g) {
+      stamp[cell] = generation;
+      parent[cell] = from;
+      cost[cell] = g;
+    }
+  };
+
+  // One scratch per thread so concurrent searches never share buffers.
+  Scratch& thread_scratch();
+
+  void build_path(const Scratch& scratch, int goal, std::vector<int>& path);
+
+  // Shortest path from start to goal, written to path as cell indices
+  // including both ends. Returns false if goal is unreachable.
+  template<typename Walkable>
+  bool bfs(int width, int height, int start, int goal, Walkable&& walkable,
+    std::vector<int>& path)
+  {
+    Scratch& scratch{thread_scratch()};
+
+    scratch.prepare(width * height);
+    scratch.visit(start, no_cell, 0);
+    scratch.queue.push_back(start);
+
+    for (std::size_t head{0}; head < scratch.queue.size(); head++) {
+      int cell{scratch.queue[head]};
+
+      if (cell == goal) {
+        build_path(scratch, goal, path);
+
+        return true;
+      }
+
+      for (const auto dir : {Dir::left, Dir::right, Dir::up, Dir::down}) {
+        int adj{step(cell, dir, width, height)};
+
+        if (adj == no_cell || scratch.visited(adj) || !walkable(adj))
+          continue;
+
+        scratch.visit(adj, cell, scratch.cost[cell] + 1);
+        scratch.queue.push_back(adj);
+      }
+    }
+
+    path.clear();
+
+    return false;
+  }
+
+  // A* with a manhattan heuristic; same contract as bfs but expands far
+  // fewer cells when the goal lies in a known direction.
+  template<typename Walkable>
+  bool a_star(int width, int height, int start, int goal,
+    Walkable&& walkable, std::vector<int>& path)
+  {
+    Scratch& scratch{thread_scratch()};
+    auto& heap{scratch.heap};
+    const int goal_c{goal % width};
+    const int goal_r{goal / width};
+
+    auto heuristic = [&](int cell) {
+      return std::abs(cell % width - goal_c) + std::abs(cell / width - goal_r);
+    };
+
+    // min-heap on f cost
+    auto cmp = [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+      return a.first > b.first;
+    };
+
+    scratch.prepare(width * height);
+    scratch.visit(start, no_cell, 0);
+    heap.push_back({heuristic(start), start});
+
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), cmp);
+      auto [f, cell] = heap.back();
+      heap.pop_back();
+
+      if (cell == goal) {
+        build_path(scratch, goal, path);
+
+        return true;
+      }
+
+      // stale entry superseded by a cheaper route
+      if (f - heuristic(cell) > scratch.cost[cell])
+        continue;
+
+      for (const auto dir : {Dir::left, Dir::right, Dir::up, Dir::down}) {
+        int adj{step(cell, dir, width, height)};
+
+        if (adj == no_cell || !walkable(adj))
+          continue;
+
+        int g{scratch.cost[cell] + 1};
+
+        if (scratch.visited(adj) && scratch.cost[adj] <= g)
+          continue;
+
+        scratch.visit(adj, cell, g);
+        heap.push_back({g + heuristic(adj), adj});
+        std::push_heap(heap.begin(), heap.end(), cmp);
+      }
+    }
+
+    path.clear();
+
+    return false;
+  }
+
+  // Multi-source breadth first distance field. One sweep gives every cell
+  // its distance to the nearest source, so any number of agents can walk
+  // towards their nearest target by descending the field.
+  class DistanceField {
+    int _width{};
+    int _height{};
+    std::vector<std::uint32_t> _stamp{};
+    std::vector<int> _dist{};
+    std::vector<int> _queue{};
+    std::uint32_t _generation{0};
+
+  public:
+    int width() const { return _width; }
+    int height() const { return _height; }
+    std::size_t memory_bytes() const;
+
+    void resize(int width, int height);
+
+    int distance(int cell) const {
+      return _stamp[cell] == _generation ? _dist[cell] : unreachable;
+    }
+
+    // Sources are cell indices; cells further than max_dist stay
+    // unreachable which bounds the sweep on large maps.
+    template<typename Walkable>
+    void build(const std::vector<int>& sources, Walkable&& walkable,
+      int max_dist = unreachable)
+    {
+      if (++_generation == 0) {
+        std::fill(_stamp.begin(), _stamp.end(), 0);
+        _generation = 1;
+      }
+
+      _queue.clear();
+
+      for (const auto cell : sources) {
+        if (_stamp[cell] == _generation)
+          continue;
+
+        _stamp[cell] = _generation;
+        _dist[cell] = 0;
+        _queue.push_back(cell);
+      }
+
+      for (std::size_t head{0}; head < _queue.size(); head++) {
+        int cell{_queue[head]};
+        int dist{_dist[cell] + 1};
+
+        if (max_dist != unreachable && dist > max_dist)
+          continue;
+
+        for (const auto dir : {Dir::left, Dir::right, Dir::up, Dir::down}) {
+          int adj{step(cell, dir, _width, _height)};
+
+          if (adj == no_cell || _stamp[adj] == _generation || !walkable(adj))
+            continue;
+
+          _stamp[adj] = _generation;
+          _dist[adj] = dist;
+          _queue.push_back(adj);
+        }
+      }
+    }
+
+    // Neighbour of cell closest to a source which free accepts, or no_cell
+    // if no neighbour improves on the current distance.
+    template<typename Free>
+    int descend(int cell, Free&& free) const {
+      int best{no_cell};
+      int best_dist{distance(cell)};
+
+      if (best_dist == unreachable || best_dist == 0)
+        return no_cell;
+
+      for (const auto dir : {Dir::left, Dir::right, Dir::up, Dir::down}) {
+        int adj{step(cell, dir, _width, _height)};
+
+        if (adj == no_cell)
+          continue;
+
+        int dist{distance(adj)};
+
+        if (dist != unreachable && dist < best_dist && free(adj)) {
+          best = adj;
+          best_dist = dist;
+        }
+      }
+
+      return best;
+    }
+  };
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Hardware miss counters for the calling thread, read with perf_event_open.
+// Counters the kernel or machine does not offer, as in most virtual
+// machines, stay unavailable and read as zero.
+class PerfCounters {
+public:
+  enum Counter {
+    cache_misses, // last level cache
+    dtlb_misses, // data TLB loads
+    page_faults,
+    count
+  };
+
+private:
+  std::array<int, count> _fds{-1, -1, -1};
+
+public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool available(Counter counter) const;
+
+  // zeroes and starts every available counter
+  void start();
+  void stop();
+
+  std::uint64_t read(Counter counter) const;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+#include "util.hpp"
+#include "bunny.hpp"
+#include "tile_map.hpp"
+#include "tile_type.hpp"
+#include "turn_events.hpp"
+#include "walk_map.hpp"
+
+template<typename T>
+struct std::hash<sf::Vector2<T>> {
+  std::size_t operator()(const sf::Vector2<T>& k) const {
+    std::size_t seed{0};
+
+    util::hash_combine(seed, k.x);
+    util::hash_combine(seed, k.y);
+
+    return seed;
+  }
+};
+
+// The classic turn rules written the straightforward way the simulation
+// was first written: a list of bunnies kept sorted by age, a hash map of
+// positions and tiles painted as bunnies change. It is kept as the
+// behaviour BunnyManager's rules::Classic must reproduce, draw for draw,
+// and emits the same events (without pool handles) so the two can be
+// compared turn by turn. Nothing here should be optimised.
+class ReferenceManager {
+  std::list<Bunny> _bunnies{};
+  std::unordered_map<sf::Vector2i, Bunny*> _bunny_pos_map{};
+  TileMap& _tile_map;
+  TileType _floor_tile{};
+  const WalkMap* _walk_map{};
+  std::vector<EventConsumer*> _consumers{};
+  bool _roster{};
+  EventBatch _events{};
+  int _turn{};
+  std::uint32_t _next_id{};
+  std::vector<bool> _cull_bunnies{};
+
+  static bool is_overaged(const Bunny& bunny);
+
+  void emit(EventType type, const Bunny& bunny, sf::Vector2i from = {});
+  void publish();
+  bool walkable(sf::Vector2i pos) const;
+  void spawn_initial(int amount);
+  Bunny& add_bunny(const Bunny& bunny, std::uint32_t mother);
+  void set_bunny_tile(const Bunny& bunny);
+  void move_bunny_adj(Bunny& bunny);
+  void mutate_adj(sf::Vector2i pos);
+  void birth_bunnies(std::list<Bunny*>& breedable_females);
+  void sort_by_age();
+  void food_shortage();
+
+public:
+  ReferenceManager(TileMap& tile_map, TileType floor_tile,
+    std::vector<EventConsumer*> consumers,
+    const WalkMap* walk_map = nullptr);
+
+  int turn() const;
+  int population() const;
+
+  bool next_turn();
+  void reset();
+};
\ No newline at end of file
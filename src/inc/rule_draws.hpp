@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include "util.hpp"
+#include "bunny.hpp"
+#include "path_finding.hpp"
+
+// Random draws every stepper following the rules makes in the same order.
+// ReferenceManager keeps its own copies on purpose, so it stays a check on
+// these.
+namespace rules {
+  // the four directions in a random order
+  inline std::array<path_finding::Dir, 4> rnd_dirs() {
+    using path_finding::Dir;
+
+    std::array<Dir, 4> dirs{Dir::left, Dir::right, Dir::up, Dir::down};
+    std::shuffle(dirs.begin(), dirs.end(), util::rng());
+
+    return dirs;
+  }
+
+  // the lifespan is drawn anew each turn and the bunny dies once its age
+  // reaches it
+  template<typename Rules>
+  bool is_overaged(const Bunny& bunny) {
+    if constexpr (Rules::infection) {
+      if (bunny.infected())
+        return bunny.age() >= util::rnd_range(Rules::min_infected_lifespan,
+          Rules::max_infected_lifespan);
+    }
+
+    return bunny.age() >= util::rnd_range(Rules::min_lifespan,
+      Rules::max_lifespan);
+  }
+}
\ No newline at end of file
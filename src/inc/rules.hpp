@@ -0,0 +1,91 @@
+#pragma once
+
+// Rule policies for BasicBunnyManager. Every parameter is a compile time
+// constant so disabled phases are removed from the turn loop entirely.
+// New policies derive from an existing one and override what they change.
+namespace rules {
+  struct Classic {
+    static constexpr int adult_age{2};
+    static constexpr int max_initial_age{10};
+    static constexpr int min_lifespan{10};
+    static constexpr int max_lifespan{12};
+    static constexpr int min_infected_lifespan{7};
+    static constexpr int max_infected_lifespan{10};
+    static constexpr int mutant_chance{100}; // 1 in n
+    static constexpr int initial_spawn{5};
+    static constexpr int bunny_limit{1000};
+
+    static constexpr bool infection{true};
+    static constexpr bool movement{true};
+    static constexpr bool food_shortage{true};
+
+    // females walk towards the nearest breedable male within seek_range
+    static constexpr bool seek_mates{false};
+    static constexpr int seek_range{16};
+
+    // per cell food replaces the global bunny_limit cull, which has to be
+    // off with it; bunnies eat food_need each turn and starve after
+    // starve_turns without enough
+    static constexpr bool food_field{false};
+    static constexpr int food_regrow{2};
+    static constexpr int food_need{24};
+    static constexpr int starve_turns{3};
+    static constexpr int food_threads{1};
+    static constexpr int grass_level{128}; // vacated cells show grass above
+
+    // bunnies on a cell too bare to feed them walk an A* route towards the
+    // richest cell within forage_range, around walls; 0 leaves them to
+    // wander
+    static constexpr int forage_range{0};
+
+    // females only breed with a male within mate_radius cells; 0 lets any
+    // male on the map do
+    static constexpr int mate_radius{0};
+    static constexpr int index_bucket_size{8};
+
+    // bunnies are updated in the order of a Hilbert curve through their
+    // cells, re-sorted every spatial_order turns, instead of by age; 0
+    // keeps the age order. The roster is listed by age either way.
+    static constexpr int spatial_order{0};
+  };
+
+  // the viewer's rules, which keep the classic outcome
+  struct Default : Classic {};
+
+  // Females only breed with a male within 32 cells and walk towards the
+  // nearest one. Opt-in, as the population dies out far more often.
+  struct Seeking : Default {
+    static constexpr int mate_radius{32};
+    static constexpr bool seek_mates{true};
+    static constexpr int seek_range{48};
+  };
+
+  struct NoInfection : Default {
+    static constexpr bool infection{false};
+  };
+
+  struct NoMovement : Default {
+    static constexpr bool movement{false};
+  };
+
+  struct Unlimited : Default {
+    static constexpr bool food_shortage{false};
+  };
+
+  // starvation limits the population instead of the cull
+  struct Grazing : Default {
+    static constexpr bool food_shortage{false};
+    static constexpr bool food_field{true};
+    static constexpr int forage_range{4};
+  };
+
+  // classic rules without the cull or infection, so a large map fills up
+  struct Crowded : Classic {
+    static constexpr bool infection{false};
+    static constexpr bool food_shortage{false};
+  };
+
+  struct Local : Crowded {
+    static constexpr int spatial_order{8};
+  };
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Shared mapping, either anonymous, which child processes forked after it
+// was made see at the same address, or named (under /dev/shm on Linux) so
+// unrelated processes can attach. Pages are zeroed and only backed once
+// touched.
+class SharedMemory {
+  void* _data{};
+  std::size_t _size{};
+  std::string _name{}; // unlinked on destruction when set
+
+public:
+  SharedMemory() = default;
+  explicit SharedMemory(std::size_t size);
+
+  // creates or replaces a named segment, owned by this process
+  static SharedMemory create(std::string_view name, std::size_t size);
+
+  // attaches read only to an existing segment at its whole size
+  static SharedMemory open(std::string_view name);
+
+  ~SharedMemory();
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+  SharedMemory(SharedMemory&& other) noexcept;
+  SharedMemory& operator=(SharedMemory&& other) noexcept;
+
+  bool valid() const;
+  void* data() const;
+  std::size_t size() const;
+};
\ No newline at end of file
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <vector>
+#include <algorithm>
+
+#include "memory_usage.hpp"
+
+// Uniform grid of buckets over the tile map. Each bucket lists the items
+// whose position falls inside it, so radius, nearest and rectangle queries
+// only visit the buckets they overlap and cost O(local density). Moves
+// within a bucket only update the stored position.
+template<typename T>
+class SpatialIndex {
+public:
+  struct Entry {
+    sf::Vector2i pos{};
+    T item{};
+  };
+
+private:
+  int _bucket_size{};
+  int _cols{};
+  int _rows{};
+  std::vector<std::vector<Entry>> _buckets{};
+  std::vector<std::pair<int, Entry>> _nearest{};
+
+  int bucket_of(sf::Vector2i pos) const {
+    return pos.y / _bucket_size * _cols + pos.x / _bucket_size;
+  }
+
+  static int dist_sq(sf::Vector2i a, sf::Vector2i b) {
+    return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+  }
+
+  Entry* find(int bucket, T item) {
+    for (auto& entry : _buckets[bucket]) {
+      if (entry.item == item)
+        return &entry;
+    }
+
+    return nullptr;
+  }
+
+  void erase_from(int bucket, T item) {
+    auto& entries{_buckets[bucket]};
+
+    for (std::size_t i{0}; i < entries.size(); i++) {
+      if (entries[i].item == item) {
+        entries[i] = entries.back();
+        entries.pop_back();
+
+        return;
+      }
+    }
+  }
+
+  // visits buckets overlapping the cell range [c0, c1] x [r0, r1]
+  template<typename F>
+  void for_each_bucket(int c0, int r0, int c1, int r1, F&& fn) const {
+    int bc0{std::max(c0, 0) / _bucket_size};
+    int br0{std::max(r0, 0) / _bucket_size};
+    int bc1{std::min(c1 / _bucket_size, _cols - 1)};
+    int br1{std::min(r1 / _bucket_size, _rows - 1)};
+
+    for (int br{br0}; br <= br1; br++) {
+      for (int bc{bc0}; bc <= bc1; bc++)
+        fn(_buckets[br * _cols + bc]);
+    }
+  }
+
+public:
+  int bucket_size() const { return _bucket_size; }
+
+  std::size_t memory_bytes() const {
+    return memory_usage::bytes(_buckets) + memory_usage::bytes(_nearest);
+  }
+
+  SpatialIndex() = default;
+
+  SpatialIndex(int width, int height, int bucket_size) :
+    _bucket_size(bucket_size),
+    _cols((width + bucket_size - 1) / bucket_size),
+    _rows((height + bucket_size - 1) / bucket_size),
+    _buckets(_cols * _rows)
+  {
+
+  }
+
+  // Gives every bucket room for per_bucket items so inserts and moves
+  // below that occupancy never allocate.
+  void reserve(int per_bucket) {
+    for (auto& entries : _buckets)
+      entries.reserve(per_bucket);
+  }
+
+  void insert(sf::Vector2i pos, T item) {
+    _buckets[bucket_of(pos)].push_back({pos, item});
+  }
+
+  void erase(sf::Vector2i pos, T item) { erase_from(bucket_of(pos), item); }
+
+  void move(sf::Vector2i from, sf::Vector2i to, T item) {
+    int old_bucket{bucket_of(from)};
+    int new_bucket{bucket_of(to)};
+
+    if (old_bucket == new_bucket) {
+      if (Entry* entry{find(old_bucket, item)})
+        entry->pos = to;
+
+      return;
+    }
+
+    erase_from(old_bucket, item);
+    insert(to, item);
+  }
+
+  // keeps bucket capacity so refilling does not allocate
+  void clear() {
+    for (auto& entries : _buckets)
+      entries.clear();
+  }
+
+  // gives back bucket capacity beyond what each bucket holds now
+  void compact() {
+    for (auto& entries : _buckets)
+      entries.shrink_to_fit();
+
+    _nearest.clear();
+    _nearest.shrink_to_fit();
+  }
+
+  // Calls fn(entry) for every item within radius (euclidean) of centre
+  template<typename F>
+  void for_each_in_radius(sf::Vector2i centre, int radius, F&& fn) const {
+    const int radius_sq{radius * radius};
+
+    for_each_bucket(centre.x - radius, centre.y - radius, centre.x + radius,
+      centre.y + radius, [&](const std::vector<Entry>& entries) {
+        for (const auto& entry : entries) {
+          if (dist_sq(entry.pos, centre) <= radius_sq)
+            fn(entry);
+        }
+      }
+    );
+  }
+
+  // True if pred accepts any item within radius of centre
+  template<typename Pred>
+  bool any_in_radius(sf::Vector2i centre, int radius, Pred&& pred) const {
+    const int radius_sq{radius * radius};
+    int bc0{std::max(centre.x - radius, 0) / _bucket_size};
+    int br0{std::max(centre.y - radius, 0) / _bucket_size};
+    int bc1{std::min((centre.x + radius) / _bucket_size, _cols - 1)};
+    int br1{std::min((centre.y + radius) / _bucket_size, _rows - 1)};
+
+    for (int br{br0}; br <= br1; br++) {
+      for (int bc{bc0}; bc <= bc1; bc++) {
+        for (const auto& entry : _buckets[br * _cols + bc]) {
+          if (dist_sq(entry.pos, centre) <= radius_sq && pred(entry))
+            return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  // Calls fn(entry) for every item inside rect
+  template<typename F>
+  void for_each_in_rect(const sf::IntRect& rect, F&& fn) const {
+    for_each_bucket(rect.left, rect.top, rect.left + rect.width - 1,
+      rect.top + rect.height - 1, [&](const std::vector<Entry>& entries) {
+        for (const auto& entry : entries) {
+          if (rect.contains(entry.pos.x, entry.pos.y))
+            fn(entry);
+        }
+      }
+    );
+  }
+
+  // Up to k items accepted by pred, nearest first. Rings of buckets are
+  // searched outwards and the search stops once no unvisited bucket can
+  // hold anything closer than the current k-th result.
+  template<typename Pred>
+  const std::vector<std::pair<int, Entry>>& nearest(sf::Vector2i centre,
+    int k, Pred&& pred)
+  {
+    _nearest.clear();
+
+    if (k <= 0)
+      return _nearest;
+
+    const int centre_bc{centre.x / _bucket_size};
+    const int centre_br{centre.y / _bucket_size};
+    const int max_ring{std::max(_cols, _rows)};
+
+    auto by_dist = [](const auto& a, const auto& b) {
+      return a.first < b.first;
+    };
+
+    for (int ring{0}; ring <= max_ring; ring++) {
+      for (int br{centre_br - ring}; br <= centre_br + ring; br++) {
+        if (br < 0 || br >= _rows)
+          continue;
+
+        bool edge_row{br == centre_br - ring || br == centre_br + ring};
+        int step{edge_row ? 1 : ring * 2};
+
+        for (int bc{centre_bc - ring}; bc <= centre_bc + ring;
+          bc += std::max(step, 1))
+        {
+          if (bc < 0 || bc >= _cols)
+            continue;
+
+          for (const auto& entry : _buckets[br * _cols + bc]) {
+            if (pred(entry))
+              _nearest.push_back({dist_sq(entry.pos, centre), entry});
+          }
+        }
+      }
+
+      if ((int)_nearest.size() >= k) {
+        std::nth_element(_nearest.begin(), _nearest.begin() + (k - 1),
+          _nearest.end(), by_dist);
+
+        int reach{ring * _bucket_size};
+
+        if (_nearest[k - 1].first <= reach * reach)
+          break;
+      }
+    }
+
+    int count{std::min<int>(k, _nearest.size())};
+
+    std::partial_sort(_nearest.begin(), _nearest.begin() + count,
+      _nearest.end(), by_dist);
+
+    _nearest.resize(count);
+
+    return _nearest;
+  }
+};
\ No newline at end of file
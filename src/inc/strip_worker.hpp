@@ -0,0 +1,121 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include "bunny.hpp"
+#include "bunny_pool.hpp"
+#include "channel.hpp"
+#include "event_consumers.hpp"
+
+namespace domain {
+  enum class CommandType : std::int32_t {
+    spawn, // value bunnies placed at random in the strip
+    turn,
+    breed, // value is nonzero if a breedable male lives anywhere
+    cull, // value bunnies removed at random
+    stop
+  };
+
+  struct Command {
+    CommandType type{};
+    int value{};
+  };
+
+  // what a strip knows of the row just past its edge, from the end of the
+  // last turn; reserved marks a cell a migrant has been sent to
+  enum class HaloCell : std::uint8_t {
+    empty,
+    healthy,
+    infected,
+    reserved
+  };
+
+  // a bunny as sent between strips; Bunny has no default constructor for
+  // the receiving buffer to use
+  typedef std::array<std::uint8_t, sizeof(Bunny)> BunnyBytes;
+
+  enum Side {
+    above,
+    below
+  };
+}
+
+// Owns the rows [row_begin, row_end) of a world split into horizontal
+// strips, one per worker process, and runs the classic turn rules on them.
+// The coordinator drives each turn through commands. Neighbouring strips
+// only see each other through the halo rows swapped at the end of a turn
+// and the messages exchanged mid-turn:
+//
+// - A bunny stepping into a free halo cell asks the neighbour to take it.
+//   It keeps its cell until the neighbour replies, and stays put if the
+//   cell was taken in the meantime.
+// - An infected bunny next to a healthy halo bunny asks the neighbour to
+//   infect it.
+//
+// Births, deaths and aging are local. Breeding needs a male anywhere in the
+// world, which the coordinator tells every strip, and food shortage culls
+// are counted out per strip by the coordinator.
+class StripWorker {
+  int _width{};
+  int _row_begin{};
+  int _row_end{};
+  Channel& _coordinator;
+  Channel* _neighbours[2]{};
+
+  BunnyPool _bunnies{};
+  std::vector<BunnyHandle> _order{}; // sorted by age
+  std::vector<BunnyHandle> _order_scratch{};
+  std::vector<int> _age_counts{};
+  std::vector<BunnyHandle> _cells{}; // per owned cell, invalid if empty
+  std::vector<domain::HaloCell> _halos[2]{};
+  std::vector<BunnyHandle> _breedable_females{};
+  std::vector<bool> _cull_bunnies{};
+  TurnStats _stats{};
+  int _breedable_males{};
+
+  // outgoing requests and the last messages received, reused every turn
+  std::vector<BunnyHandle> _migrants[2]{};
+  std::vector<sf::Vector2i> _migrant_targets[2]{};
+  std::vector<domain::BunnyBytes> _migrant_records{};
+  std::vector<sf::Vector2i> _infections[2]{};
+  std::vector<domain::BunnyBytes> _incoming{};
+  std::vector<sf::Vector2i> _incoming_infections{};
+  std::vector<std::uint8_t> _replies[2]{};
+  std::vector<std::uint8_t> _incoming_replies{};
+  std::vector<domain::HaloCell> _halo_out{};
+
+  bool owns(int row) const;
+  int cell_index(sf::Vector2i pos) const;
+  bool occupied(sf::Vector2i pos) const;
+  domain::HaloCell* halo_cell(sf::Vector2i pos);
+
+  BunnyHandle add_bunny(const Bunny& bunny);
+  void remove_bunny(BunnyHandle handle);
+  void spawn(int amount);
+  void move_bunny_adj(BunnyHandle handle);
+  void mutate_adj(sf::Vector2i pos);
+  void birth_bunnies();
+  void sort_by_age();
+  void cull(int amount);
+  void compact_order();
+
+  // sends below, receives from above, sends above, receives from below,
+  // which cannot deadlock however small the transport's buffers are
+  template<typename Send, typename Receive>
+  void exchange(Send send, Receive receive);
+
+  void exchange_requests();
+  void exchange_halos();
+  void turn();
+
+public:
+  // neighbours are nullptr at the world's top and bottom edges
+  StripWorker(int width, int row_begin, int row_end, Channel& coordinator,
+    Channel* above, Channel* below);
+
+  // serves commands until told to stop
+  void run();
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string_view>
+#include <atomic>
+#include <cstdint>
+
+#include "shared_memory.hpp"
+#include "turn_timings.hpp"
+
+struct TelemetryRecord {
+  std::int32_t turn{};
+  std::int32_t population{};
+  std::int32_t infected{}; // living infected bunnies
+  std::int32_t births{};
+  std::int32_t deaths{};
+  std::int32_t infections{};
+  std::int32_t culls{};
+  std::int32_t moves{};
+  TurnTimings timings{};
+};
+
+// Per turn telemetry in a named shared memory ring (/dev/shm/<name> on
+// Linux) that monitors attach to without involving the simulation. There
+// is one writer, and it never waits. Each slot carries a sequence number,
+// odd while the writer fills it. Readers copy a slot and check the number
+// is unchanged and matches the record they wanted; otherwise the writer
+// lapped them. Publishing is two stores and a copy into mapped memory, so
+// it makes no syscalls.
+namespace telemetry {
+  constexpr std::string_view default_name{"/bunny_telemetry"};
+  constexpr std::uint64_t magic{0x314d544e4e5542}; // "BUNNTM1"
+  constexpr std::uint32_t default_capacity{4096}; // records
+
+  struct Slot {
+    std::atomic<std::uint64_t> sequence;
+    TelemetryRecord record;
+  };
+
+  struct Header {
+    std::atomic<std::uint64_t> magic;
+    std::uint32_t capacity;
+    std::uint32_t record_size;
+    alignas(64) std::atomic<std::uint64_t> written; // records published
+    std::atomic<std::uint32_t> closed; // set when the writer goes away
+  };
+}
+
+class TelemetryWriter {
+  SharedMemory _memory{};
+  telemetry::Header* _header{};
+  telemetry::Slot* _slots{};
+  std::uint64_t _next{};
+
+public:
+  explicit TelemetryWriter(std::string_view name = telemetry::default_name,
+    std::uint32_t capacity = telemetry::default_capacity);
+  ~TelemetryWriter();
+
+  bool valid() const;
+
+  void publish(const TelemetryRecord& record);
+};
+
+class TelemetryReader {
+  SharedMemory _memory{};
+  const telemetry::Header* _header{};
+  const telemetry::Slot* _slots{};
+
+public:
+  // not attached if the ring does not exist yet or is not a telemetry ring
+  explicit TelemetryReader(std::string_view name = telemetry::default_name);
+
+  bool attached() const;
+  std::uint32_t capacity() const;
+  std::uint64_t written() const;
+  bool closed() const;
+
+  // false if record index is not in the ring, or was overwritten mid copy
+  bool read(std::uint64_t index, TelemetryRecord& record) const;
+};
\ No newline at end of file
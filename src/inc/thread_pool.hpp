@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of worker threads shared by queued jobs and parallel_for
+// batches. A batch only stores a function pointer and context so running
+// one never allocates.
+class ThreadPool {
+  std::vector<std::thread> _workers{};
+  std::deque<std::function<void()>> _jobs{};
+  std::mutex _mutex{};
+  std::condition_variable _work_cv{};
+  std::condition_variable _done_cv{};
+  int _busy{0};
+  bool _stop{};
+
+  void (*_batch_fn)(void*, int){};
+  void* _batch_ctx{};
+  int _batch_count{};
+  std::atomic<int> _batch_next{};
+  int _batch_remaining{};
+  int _batch_workers{};
+  unsigned _batch_generation{};
+
+  void worker();
+  void run_batch();
+
+public:
+  // threads of 0 uses every hardware thread
+  explicit ThreadPool(int threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int size() const;
+
+  void submit(std::function<void()> job);
+  void wait();
+
+  // Calls fn(i) for every i in [0, count) across the workers and the
+  // calling thread, returning once all calls have finished.
+  template<typename F>
+  void parallel_for(int count, F&& fn) {
+    auto trampoline = [](void* ctx, int i) { (*static_cast<F*>(ctx))(i); };
+
+    parallel_for(count, +trampoline, &fn);
+  }
+
+  void parallel_for(int count, void (*fn)(void*, int), void* ctx);
+};
\ No newline at end of file
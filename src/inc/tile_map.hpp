@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <SFML/Graphics/Rect.hpp>
 
 class TileMap {
   int _width{};
@@ -8,6 +9,10 @@ class TileMap {
   std::vector<std::vector<int>> _data{};
   int _tile_size{};
   std::vector<std::pair<int, int>> _modified_tiles{};
+  bool _all_modified{};
+
+  int max_modified_tiles() const;
+  void add_modified_tile(int c, int r);
 
 public:
   int width() const;
@@ -15,6 +20,8 @@ public:
   const std::vector<std::vector<int>>& data() const;
   int tile_size() const;
   const std::vector<std::pair<int, int>>& modified_tiles() const;
+  bool all_modified() const; // modified_tiles is empty when set
+  std::size_t memory_bytes() const;
 
   TileMap(int width, int height, int tile_size, int tile);
 
@@ -23,4 +30,5 @@ public:
   bool in_bounds(int c, int r) const;
   int get_tile(int c, int r) const;
   void set_tile(int c, int r, int tile);
+  void fill_rect(const sf::IntRect& rect, int tile);
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "tile_type.hpp"
+
+// Tile images scaled to a fixed pixel size and flattened over the floor
+// tile on the CPU, so frames can be rasterised by copying rows without a
+// display or GPU context.
+class TileRaster {
+  int _tile_px{};
+  std::vector<std::uint8_t> _tiles{}; // RGBA, tile_px * tile_px per type
+  std::vector<std::uint8_t> _colours{}; // RGBA average of each tile
+
+public:
+  static constexpr int channels{4};
+
+  int tile_px() const;
+
+  const std::uint8_t* tile(int tile) const {
+    return &_tiles[tile * _tile_px * _tile_px * channels];
+  }
+
+  const std::uint8_t* colour(int tile) const {
+    return &_colours[tile * channels];
+  }
+
+  // false if a tile image fails to load
+  bool load(int tile_px, TileType floor_tile);
+
+  // Rasterises rows [r0, r1) of a cell grid holding one tile type per cell.
+  // pixels points at the frame's first pixel, whose rows are
+  // width * tile_px pixels wide.
+  void rasterise(const std::uint8_t* cells, int width, int r0, int r1,
+    std::uint8_t* pixels) const;
+};
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+#include <string_view>
+
 enum class TileType {
   dirt,
   white_adult,
@@ -18,5 +21,39 @@ enum class TileType {
   spotted_adult_mutant,
   spotted_juvenile,
   spotted_juvenile_mutant,
+  wall,
+  grass,
   end
-};
\ No newline at end of file
+};
+
+// file names under resources/tiles, in enum order
+const std::string_view tile_type_str[] {
+  "dirt",
+  "white_adult",
+  "white_adult_mutant",
+  "white_juvenile",
+  "white_juvenile_mutant",
+  "brown_adult",
+  "brown_adult_mutant",
+  "brown_juvenile",
+  "brown_juvenile_mutant",
+  "black_adult",
+  "black_adult_mutant",
+  "black_juvenile",
+  "black_juvenile_mutant",
+  "spotted_adult",
+  "spotted_adult_mutant",
+  "spotted_juvenile",
+  "spotted_juvenile_mutant",
+  "wall",
+  "grass",
+};
+
+inline std::string get_tile_dir(TileType tile_type) {
+  std::string dir("resources/tiles/");
+
+  dir.append(tile_type_str[(int)tile_type]);
+  dir.append(".png");
+
+  return dir;
+}
\ No newline at end of file
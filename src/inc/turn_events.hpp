@@ -0,0 +1,74 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+#include <cstdint>
+
+#include "bunny.hpp"
+#include "bunny_pool.hpp"
+#include "turn_timings.hpp"
+
+enum class EventType : std::uint8_t {
+  born,
+  moved,
+  infected,
+  died,
+  culled,
+  removed, // cleared by a reset
+  shortage,
+  roster_begin,
+  remaining,
+  roster_end
+};
+
+// Snapshot of a bunny at the moment something happened to it, so consumers
+// never need to look the bunny up (it may already be dead).
+struct TurnEvent {
+  static constexpr std::uint8_t infected_flag{1};
+  static constexpr std::uint8_t adult_flag{2};
+  static constexpr std::uint8_t starved_flag{4}; // died of hunger, not age
+
+  EventType type{};
+  std::uint8_t colour{};
+  std::uint8_t gender{};
+  std::uint8_t flags{};
+  std::uint8_t floor{}; // tile left behind by moved, died, culled, removed
+  std::uint16_t age{};
+  std::uint16_t name{};
+  BunnyHandle bunny{};
+  std::uint32_t id{Bunny::no_id};
+  std::uint32_t mother{Bunny::no_id}; // of a bunny born this turn
+  sf::Vector2i pos{};
+  sf::Vector2i from{}; // previous position of a moved bunny
+
+  bool infected() const { return flags & infected_flag; }
+  bool adult() const { return flags & adult_flag; }
+  bool starved() const { return flags & starved_flag; }
+};
+
+// Everything one turn (or the initial spawn, turn 0) produced. The manager
+// reuses one batch so recording events does not allocate once warmed up.
+struct EventBatch {
+  int turn{};
+  std::vector<TurnEvent> events{};
+  TurnTimings timings{};
+
+  void clear(int new_turn) {
+    turn = new_turn;
+    events.clear();
+    timings = TurnTimings{};
+  }
+};
+
+class EventConsumer {
+public:
+  virtual ~EventConsumer() = default;
+
+  virtual void consume(const EventBatch& batch) = 0;
+
+  // the roster lists every bunny each turn so is only produced on request
+  virtual bool wants_roster() const { return false; }
+
+  // as is timing the turn's phases
+  virtual bool wants_timings() const { return false; }
+};
\ No newline at end of file
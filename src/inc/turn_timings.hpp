@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Nanoseconds spent in each phase of the turn, measured only when a
+// consumer asks for them. Kept apart from the events so the telemetry
+// monitor builds without SFML.
+struct TurnTimings {
+  std::int64_t food{};
+  std::int64_t update{}; // deaths, moves, infections and aging
+  std::int64_t births{};
+  std::int64_t sort{}; // includes building the mate field
+  std::int64_t shortage{}; // the roster and any cull
+};
\ No newline at end of file
@@ -7,8 +7,20 @@
 #define ARR_SIZE(a) (sizeof(a) / sizeof(a[0]))
 
 namespace util {
+  typedef std::mt19937 rng_t;
+
+  // Engine behind every random draw, one per thread. It is seeded from
+  // std::random_device unless seed is called, which makes runs repeatable.
+  rng_t& rng();
+  void seed(std::uint32_t value);
+
   int rnd_range(int min, int max);
   bool rnd_bool();
+
+  // Distance of a cell along a Hilbert curve filling a side by side square,
+  // side being a power of two. Cells close on the curve are close on the
+  // map.
+  std::uint32_t hilbert_index(int side, int x, int y);
   
   template <typename T>
   T rnd_enum_class() {
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "tile_map.hpp"
+
+// Walkability precomputed from a tile map as one bit per cell, plus
+// connected component labels so reachability is a single comparison.
+// Rebuild after the tile map's terrain changes; bunnies are not terrain.
+class WalkMap {
+  int _width{};
+  int _height{};
+  std::vector<std::uint64_t> _bits{};
+  std::vector<int> _labels{};
+  std::vector<int> _component_sizes{};
+  int _largest_component{no_component};
+
+  void label_components();
+
+public:
+  static constexpr int no_component{-1};
+
+  int width() const;
+  int height() const;
+  int component_count() const;
+  int largest_component() const;
+  int component_size(int component) const;
+
+  WalkMap() = default;
+  WalkMap(const TileMap& tile_map, int blocked_tile);
+
+  void build(const TileMap& tile_map, int blocked_tile);
+
+  bool walkable(int cell) const {
+    return _bits[cell >> 6] >> (cell & 63) & 1;
+  }
+
+  bool walkable(int c, int r) const { return walkable(r * _width + c); }
+
+  int component(int cell) const { return _labels[cell]; }
+  int component(int c, int r) const { return _labels[r * _width + c]; }
+};
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "rules.hpp"
+
+// What sets one world of a batch apart; the defaults are the classic rules.
+struct WorldParams {
+  int bunny_limit{rules::Classic::bunny_limit};
+  int initial_spawn{rules::Classic::initial_spawn};
+  int mutant_chance{rules::Classic::mutant_chance}; // 1 in n, 0 for none
+};
+
+struct WorldResult {
+  int population{};
+  int infected{};
+  std::int64_t births{};
+  std::int64_t deaths{};
+  std::int64_t infections{};
+  std::int64_t culls{};
+  int extinctions{}; // respawns after every bunny died
+};
+
+// Steps up to lanes independent square worlds under the classic rules in
+// lockstep, bit-sliced: each flag of a cell is a word with a bit for every
+// world and a bunny's age is four such words. A phase then tests, moves and
+// ages the bunnies of all worlds in a cell with a few dozen word operations
+// and no branch on any one world. Random draws are hashed words whose bit w
+// is world w's, so a world is reproduced by the batch seed and its place in
+// the batch.
+//
+// Cells are walked in row order rather than bunnies by age, so a run
+// follows the rules but not the sequence of a BunnyManager:
+//
+// - a bunny that moved into a later cell is not updated again that turn;
+// - infected bunnies infect once every bunny has moved, and one infected
+//   that turn waits for the next to pass it on, so infection spreads a
+//   cell a turn where down the age order it can run further;
+// - chances of a third are drawn to a byte;
+// - a shortage keeps half the limit by selection sampling along the walk.
+//
+// A world that dies out is respawned, as main resets a BunnyManager.
+class WorldBatch {
+public:
+  using Word = std::uint64_t;
+
+  static constexpr int lanes{64}; // a world for each bit of a word
+  static constexpr int planes{10};
+
+  template<typename T>
+  using LaneArray = std::array<T, lanes>;
+
+  // a cell's words, laid out in world_batch.cpp
+  using Cell = std::array<Word, planes>;
+
+private:
+  // bit i of world w's count is bit w of bits[i], so a word of worlds is
+  // counted with a carry chain
+  struct SlicedCount {
+    std::array<Word, 32> bits{};
+
+    void add(Word ones);
+    std::int64_t take(int lane) const;
+  };
+
+  int _size{};
+  int _side{}; // with a border of wall cells
+  int _worlds{};
+  int _turn{};
+  std::uint64_t _seed{};
+  std::vector<Cell> _cells{};
+  std::vector<Word> _fresh{}; // worlds whose bunny was infected this turn
+  LaneArray<WorldParams> _params{};
+  LaneArray<std::uint32_t> _mutant_thresholds{}; // of 2^16
+  std::array<Word, 16> _mutant_bits{}; // bit i of each world's threshold
+  LaneArray<int> _population{};
+  Word _has_male{}; // worlds with a breedable male this turn
+
+  // counted a word of worlds at a time and taken into the totals at the
+  // end of each turn
+  SlicedCount _births{};
+  SlicedCount _deaths{};
+  SlicedCount _infections{};
+  LaneArray<WorldResult> _totals{};
+
+  std::uint64_t key(std::uint64_t phase) const;
+  int adjacent(int cell, int dir) const; // left, right, up, down
+  void infect_adj(int lane, int cell, std::uint32_t keys);
+  void spawn(int lane);
+
+  void update();
+  void infect();
+  void birth();
+  void cull();
+
+public:
+  // at most lanes worlds; the rest of the lanes stay empty
+  WorldBatch(int size, std::uint64_t seed,
+    const std::vector<WorldParams>& worlds);
+
+  int worlds() const;
+  int turn() const;
+
+  void next_turn();
+  std::vector<WorldResult> results() const;
+};
\ No newline at end of file
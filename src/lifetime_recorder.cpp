@@ -0,0 +1,258 @@
+#include <charconv>
+
+#include "lifetime_recorder.hpp"
+
+struct ColumnInfo {
+  std::string_view name;
+  char type;
+};
+
+// in the order Block's columns are written
+static const ColumnInfo columns[] {
+  {"id", 'U'},
+  {"mother", 'U'},
+  {"birth_turn", 'I'},
+  {"death_turn", 'I'},
+  {"cause", 'B'},
+  {"colour", 'B'},
+  {"gender", 'B'},
+  {"infected_turn", 'I'},
+  {"birth_x", 'I'},
+  {"birth_y", 'I'}
+};
+
+static const std::string_view cause_str[] {
+  "alive",
+  "age",
+  "starved",
+  "culled",
+  "removed"
+};
+
+template<typename T>
+static void write_column(std::ofstream& ofs, const std::vector<T>& column) {
+  ofs.write(reinterpret_cast<const char*>(column.data()),
+    column.size() * sizeof(T));
+}
+
+static void append_int(std::string& str, std::int64_t value) {
+  char buf[24];
+  auto result{std::to_chars(buf, buf + sizeof(buf), value)};
+
+  str.append(buf, result.ptr);
+}
+
+LifetimeRecorder::LifetimeRecorder(std::string_view file_name,
+  Format format) :
+    _ofs(std::string(file_name), std::ios::binary),
+    _format(format)
+{
+  _block.id.reserve(block_rows);
+  _block.mother.reserve(block_rows);
+  _block.birth_turn.reserve(block_rows);
+  _block.death_turn.reserve(block_rows);
+  _block.cause.reserve(block_rows);
+  _block.colour.reserve(block_rows);
+  _block.gender.reserve(block_rows);
+  _block.infected_turn.reserve(block_rows);
+  _block.birth_x.reserve(block_rows);
+  _block.birth_y.reserve(block_rows);
+
+  write_header();
+}
+
+LifetimeRecorder::~LifetimeRecorder() { finish(); }
+
+std::uint64_t LifetimeRecorder::rows() const { return _rows; }
+
+void LifetimeRecorder::write_header() {
+  if (_format == Format::csv) {
+    for (const auto& column : columns) {
+      if (&column != columns)
+        _ofs << ",";
+
+      _ofs << column.name;
+    }
+
+    _ofs << "\n";
+
+    return;
+  }
+
+  std::uint32_t count(ARR_SIZE(columns));
+
+  _ofs.write("BUNNYLT1", 8);
+  _ofs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+  for (const auto& column : columns) {
+    std::uint8_t length(column.name.size());
+
+    _ofs.put(column.type);
+    _ofs.put(length);
+    _ofs.write(column.name.data(), length);
+  }
+}
+
+void LifetimeRecorder::write_columnar() {
+  std::uint32_t count(_block.size());
+
+  _ofs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  write_column(_ofs, _block.id);
+  write_column(_ofs, _block.mother);
+  write_column(_ofs, _block.birth_turn);
+  write_column(_ofs, _block.death_turn);
+  write_column(_ofs, _block.cause);
+  write_column(_ofs, _block.colour);
+  write_column(_ofs, _block.gender);
+  write_column(_ofs, _block.infected_turn);
+  write_column(_ofs, _block.birth_x);
+  write_column(_ofs, _block.birth_y);
+}
+
+// mother is left empty for initial bunnies and the turns are -1 when the
+// bunny is alive or was never infected
+void LifetimeRecorder::write_csv() {
+  for (int i{0}; i < _block.size(); i++) {
+    _line.clear();
+    append_int(_line, _block.id[i]);
+    _line.append(",");
+
+    if (_block.mother[i] != Bunny::no_id)
+      append_int(_line, _block.mother[i]);
+
+    _line.append(",");
+    append_int(_line, _block.birth_turn[i]);
+    _line.append(",");
+    append_int(_line, _block.death_turn[i]);
+    _line.append(",");
+    _line.append(cause_str[_block.cause[i]]);
+    _line.append(",");
+    _line.append(bunny_colour_str[_block.colour[i]]);
+    _line.append(",");
+    _line.append((Gender)_block.gender[i] == Gender::male ? "male" : "female");
+    _line.append(",");
+    append_int(_line, _block.infected_turn[i]);
+    _line.append(",");
+    append_int(_line, _block.birth_x[i]);
+    _line.append(",");
+    append_int(_line, _block.birth_y[i]);
+    _line.append("\n");
+
+    _ofs << _line;
+  }
+}
+
+void LifetimeRecorder::flush() {
+  if (_block.size() == 0)
+    return;
+
+  if (_format == Format::csv)
+    write_csv();
+
+  else
+    write_columnar();
+
+  _block.id.clear();
+  _block.mother.clear();
+  _block.birth_turn.clear();
+  _block.death_turn.clear();
+  _block.cause.clear();
+  _block.colour.clear();
+  _block.gender.clear();
+  _block.infected_turn.clear();
+  _block.birth_x.clear();
+  _block.birth_y.clear();
+}
+
+void LifetimeRecorder::add_row(const Live& live, DeathCause cause, int turn) {
+  _block.id.push_back(live.id);
+  _block.mother.push_back(live.mother);
+  _block.birth_turn.push_back(live.birth_turn);
+  _block.death_turn.push_back(turn);
+  _block.cause.push_back((std::uint8_t)cause);
+  _block.colour.push_back(live.colour);
+  _block.gender.push_back(live.gender);
+  _block.infected_turn.push_back(live.infected_turn);
+  _block.birth_x.push_back(live.birth_pos.x);
+  _block.birth_y.push_back(live.birth_pos.y);
+  _rows++;
+
+  if (_block.size() >= block_rows)
+    flush();
+}
+
+void LifetimeRecorder::end_life(const TurnEvent& event, DeathCause cause,
+  int turn)
+{
+  std::uint32_t slot{event.bunny.index()};
+
+  if (slot >= _live.size() || !_live[slot].alive)
+    return;
+
+  add_row(_live[slot], cause, turn);
+  _live[slot].alive = false;
+}
+
+void LifetimeRecorder::consume(const EventBatch& batch) {
+  for (const auto& event : batch.events) {
+    std::uint32_t slot{event.bunny.index()};
+
+    switch (event.type) {
+      case EventType::born:
+        if (slot >= _live.size())
+          _live.resize(slot + 1);
+
+        _live[slot] = Live{
+          true, event.colour, event.gender, event.id, event.mother,
+          batch.turn, event.infected() ? batch.turn : -1, event.pos
+        };
+
+        break;
+
+      case EventType::infected:
+        if (slot < _live.size() && _live[slot].infected_turn < 0)
+          _live[slot].infected_turn = batch.turn;
+
+        break;
+
+      case EventType::died:
+        end_life(event,
+          event.starved() ? DeathCause::starved : DeathCause::age,
+          batch.turn);
+
+        break;
+
+      case EventType::culled:
+        end_life(event, DeathCause::culled, batch.turn);
+
+        break;
+
+      // a reset's batch is numbered 0 so the last turn played is used
+      case EventType::removed:
+        end_life(event, DeathCause::removed, _turn);
+
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  _turn = batch.turn;
+}
+
+void LifetimeRecorder::finish() {
+  if (_finished)
+    return;
+
+  for (auto& live : _live) {
+    if (live.alive)
+      add_row(live, DeathCause::alive, -1);
+
+    live.alive = false;
+  }
+
+  flush();
+  _ofs.flush();
+  _finished = true;
+}
\ No newline at end of file
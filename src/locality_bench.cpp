@@ -0,0 +1,112 @@
+#include <array>
+#include <chrono>
+#include <iomanip>
+
+#include "locality_bench.hpp"
+#include "bunny_manager.hpp"
+#include "event_consumers.hpp"
+#include "perf_counters.hpp"
+
+namespace locality_bench {
+  static const TileType floor_tile{TileType::dirt};
+  static constexpr std::uint32_t seed{1};
+  static constexpr double fill{0.125};
+  static constexpr int max_warm_up_turns{2000};
+
+  struct Result {
+    double updates{}; // bunnies alive at the start of each turn, summed
+    double seconds{};
+    std::array<std::uint64_t, PerfCounters::count> misses{};
+  };
+
+  static const char* const counter_names[PerfCounters::count] {
+    "cache misses", "dTLB misses", "page faults"
+  };
+
+  template<typename Rules>
+  static Result measure(int size, int turns, PerfCounters& counters) {
+    util::seed(seed);
+
+    TileMap tile_map(size, size, 1, (int)floor_tile);
+    TilePainter tile_painter(tile_map);
+    BasicBunnyManager<Rules> manager(tile_map, floor_tile, {&tile_painter});
+    const int target(size * (double)size * fill);
+
+    for (int turn{0}; turn < max_warm_up_turns &&
+      manager.bunnies().size() < target; turn++)
+    {
+      if (manager.next_turn())
+        manager.reset();
+    }
+
+    Result result{};
+    auto start{std::chrono::steady_clock::now()};
+
+    counters.start();
+
+    for (int turn{0}; turn < turns; turn++) {
+      result.updates += manager.bunnies().size();
+
+      if (manager.next_turn())
+        manager.reset();
+    }
+
+    counters.stop();
+
+    std::chrono::duration<double> elapsed{
+      std::chrono::steady_clock::now() - start
+    };
+
+    result.seconds = elapsed.count();
+
+    for (int counter{0}; counter < PerfCounters::count; counter++)
+      result.misses[counter] = counters.read((PerfCounters::Counter)counter);
+
+    return result;
+  }
+
+  static void print(const char* order, const Result& result,
+    const PerfCounters& counters, std::ostream& out)
+  {
+    double updates{std::max(result.updates, 1.0)};
+
+    out << std::setw(8) << order << std::setw(14) << (long long)result.updates
+      << std::setw(12) << result.seconds * 1e9 / updates;
+
+    for (int counter{0}; counter < PerfCounters::count; counter++) {
+      if (counters.available((PerfCounters::Counter)counter))
+        out << std::setw(14) << result.misses[counter] / updates;
+
+      else
+        out << std::setw(14) << "-";
+    }
+
+    out << "\n";
+  }
+
+  int run(int size, int turns, std::ostream& out) {
+    PerfCounters counters{};
+
+    Result by_age{measure<rules::Crowded>(size, turns, counters)};
+    Result spatial{measure<rules::Local>(size, turns, counters)};
+
+    out << std::fixed << std::setprecision(3) << turns << " turns on a " <<
+      size << " by " << size << " map, per bunny update:\n";
+
+    out << std::setw(8) << "order" << std::setw(14) << "updates" <<
+      std::setw(12) << "ns";
+
+    for (const auto name : counter_names)
+      out << std::setw(14) << name;
+
+    out << "\n";
+
+    print("age", by_age, counters, out);
+    print("hilbert", spatial, counters, out);
+
+    if (!counters.available(PerfCounters::cache_misses))
+      out << "Hardware counters are not available on this machine\n";
+
+    return 0;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,281 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+
+#include "config.h"
+#include "log_segments.hpp"
+#include "lz.hpp"
+
+#ifdef BUNNY_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace log_segments {
+  static constexpr std::size_t block_size{1 << 20}; // lz input per block
+  static constexpr std::size_t no_end{~std::size_t(0)};
+  static const char* const gz_suffix{".gz"};
+  static const char* const lz_suffix{".lz"};
+  static const char* const tmp_suffix{".tmp"};
+  static const int segment_digits{6};
+
+  std::string segment_path(std::string_view file_name, int segment) {
+    fs::path path(file_name);
+    char number[16];
+
+    std::snprintf(number, sizeof(number), ".%0*d", segment_digits, segment);
+
+    return (path.parent_path() / (path.stem().string() + number +
+      path.extension().string())).string();
+  }
+
+  std::string index_path(std::string_view file_name) {
+    return fs::path(file_name).replace_extension(".idx").string();
+  }
+
+  // stem.NNNNNN followed by anything, so compressed and half written
+  // segments go too
+  void remove_all(std::string_view file_name) {
+    fs::path path(file_name);
+    fs::path dir{path.has_parent_path() ? path.parent_path() : fs::path(".")};
+    std::string prefix{path.stem().string() + "."};
+    std::error_code error{};
+
+    for (const auto& entry : fs::directory_iterator(dir, error)) {
+      std::string name{entry.path().filename().string()};
+
+      if (name.size() < prefix.size() + segment_digits ||
+        name.compare(0, prefix.size(), prefix) != 0)
+      {
+        continue;
+      }
+
+      bool numbered{true};
+
+      for (int i{0}; i < segment_digits; i++)
+        numbered = numbered && std::isdigit(name[prefix.size() + i]);
+
+      if (numbered)
+        fs::remove(entry.path(), error);
+    }
+
+    fs::remove(index_path(file_name), error);
+  }
+
+  static bool read_file(const std::string& path, std::string& data) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::ostringstream contents{};
+
+    contents << ifs.rdbuf();
+    data = contents.str();
+
+    return (bool)ifs;
+  }
+
+#ifdef BUNNY_HAVE_ZLIB
+  static bool write_compressed(const std::string& data,
+    const std::string& path)
+  {
+    gzFile file{gzopen(path.c_str(), "wb")};
+
+    if (!file)
+      return false;
+
+    bool written{data.empty() ||
+      gzwrite(file, data.data(), data.size()) == (int)data.size()};
+
+    return gzclose(file) == Z_OK && written;
+  }
+#else
+  // blocks of at most block_size input, each its input size, packed size
+  // and lz stream, so reading skips the blocks before an offset
+  static bool write_compressed(const std::string& data,
+    const std::string& path)
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    std::string packed{};
+
+    for (std::size_t start{0}; start < data.size(); start += block_size) {
+      std::string_view block{std::string_view(data).substr(start, block_size)};
+
+      packed.clear();
+      lz::compress(block, packed);
+
+      std::uint32_t sizes[2]{(std::uint32_t)block.size(),
+        (std::uint32_t)packed.size()};
+
+      ofs.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+      ofs.write(packed.data(), packed.size());
+    }
+
+    return (bool)ofs;
+  }
+#endif
+
+  // written under a temporary name and renamed, so a reader sees either
+  // the plain segment or the whole compressed one
+  bool compress(const std::string& path) {
+    std::string data{};
+
+    if (!read_file(path, data))
+      return false;
+
+#ifdef BUNNY_HAVE_ZLIB
+    std::string packed_path{path + gz_suffix};
+#else
+    std::string packed_path{path + lz_suffix};
+#endif
+
+    std::string tmp_path{packed_path + tmp_suffix};
+    std::error_code error{};
+
+    if (!write_compressed(data, tmp_path)) {
+      fs::remove(tmp_path, error);
+
+      return false;
+    }
+
+    fs::rename(tmp_path, packed_path, error);
+
+    if (error)
+      return false;
+
+    fs::remove(path, error);
+
+    return true;
+  }
+
+  static bool read_plain(const std::string& path, std::size_t begin,
+    std::size_t end, std::string& out)
+  {
+    std::ifstream ifs(path, std::ios::binary);
+
+    if (!ifs || !ifs.seekg(begin))
+      return false;
+
+    char buf[4096];
+
+    while (begin < end && ifs) {
+      ifs.read(buf, std::min(sizeof(buf), end - begin));
+      out.append(buf, ifs.gcount());
+      begin += ifs.gcount();
+    }
+
+    return true;
+  }
+
+#ifdef BUNNY_HAVE_ZLIB
+  static bool read_gz(const std::string& path, std::size_t begin,
+    std::size_t end, std::string& out)
+  {
+    gzFile file{gzopen(path.c_str(), "rb")};
+
+    if (!file)
+      return false;
+
+    bool found{gzseek(file, begin, SEEK_SET) == (z_off_t)begin};
+    char buf[4096];
+
+    while (found && begin < end) {
+      int read{gzread(file, buf, std::min(sizeof(buf), end - begin))};
+
+      if (read <= 0)
+        break;
+
+      out.append(buf, read);
+      begin += read;
+    }
+
+    gzclose(file);
+
+    return found;
+  }
+#endif
+
+  static bool read_lz(const std::string& path, std::size_t begin,
+    std::size_t end, std::string& out)
+  {
+    std::ifstream ifs(path, std::ios::binary);
+    std::size_t block_start{0};
+    std::string packed{};
+    std::string block{};
+
+    if (!ifs)
+      return false;
+
+    std::uint32_t sizes[2]{};
+
+    while (block_start < end &&
+      ifs.read(reinterpret_cast<char*>(sizes), sizeof(sizes)))
+    {
+      std::size_t block_end{block_start + sizes[0]};
+
+      if (block_end <= begin) {
+        ifs.seekg(sizes[1], std::ios::cur);
+        block_start = block_end;
+
+        continue;
+      }
+
+      packed.resize(sizes[1]);
+      block.clear();
+
+      if (!ifs.read(packed.data(), packed.size()) ||
+        !lz::decompress(packed, block) || block.size() != sizes[0])
+      {
+        return false;
+      }
+
+      std::size_t from{std::max(begin, block_start) - block_start};
+      std::size_t to{std::min(end, block_end) - block_start};
+
+      out.append(block, from, to - from);
+      block_start = block_end;
+    }
+
+    return true;
+  }
+
+  // the turn's line and the start of the next turn in the same segment, if
+  // any; a reset starts the index again so the last match is the newest
+  bool read_turn(std::string_view file_name, int turn, std::string& out) {
+    std::ifstream index(index_path(file_name));
+    int line_turn{};
+    int segment{};
+    std::size_t offset{};
+    int found_segment{-1};
+    std::size_t begin{};
+    std::size_t end{no_end};
+
+    while (index >> line_turn >> segment >> offset) {
+      if (found_segment >= 0 && end == no_end && segment == found_segment)
+        end = offset;
+
+      if (line_turn == turn) {
+        found_segment = segment;
+        begin = offset;
+        end = no_end;
+      }
+    }
+
+    if (found_segment < 0)
+      return false;
+
+    std::string path{segment_path(file_name, found_segment)};
+    std::error_code error{};
+
+    if (fs::exists(path, error))
+      return read_plain(path, begin, end, out);
+
+#ifdef BUNNY_HAVE_ZLIB
+    if (fs::exists(path + gz_suffix, error))
+      return read_gz(path + gz_suffix, begin, end, out);
+#endif
+
+    return read_lz(path + lz_suffix, begin, end, out);
+  }
+}
\ No newline at end of file
@@ -1,21 +1,110 @@
 #include <iostream>
 
 #include "logger.hpp"
+#include "log_segments.hpp"
+#include "memory_usage.hpp"
 
-Logger::Logger(std::string_view file_name, bool console_output) :
-  _file_name(file_name), to_console(console_output)
+Logger::Logger(std::string_view file_name, bool console_output,
+  SegmentOptions segments) :
+    _file_name(file_name), _segments(segments), to_console(console_output)
 {
-  _ofs.open(_file_name);
+  _buffer.resize(buffer_size);
+
+  if (!_segments.enabled()) {
+    open(_ofs, _buffer, _file_name);
+
+    return;
+  }
+
+  _index_buffer.resize(buffer_size);
+  _compressors = std::make_unique<ThreadPool>(_segments.compress_threads);
+  open_segments();
+}
+
+// the open segment is compressed too, so this waits for every segment
+Logger::~Logger() {
+  if (!_segments.enabled())
+    return;
+
+  close_segment();
+  _compressors->wait();
+}
+
+std::size_t Logger::memory_bytes() const {
+  return memory_usage::bytes(_buffer) + memory_usage::bytes(_index_buffer);
+}
+
+// the buffer has to be handed over before every open to be used
+void Logger::open(std::ofstream& ofs, std::vector<char>& buffer,
+  const std::string& path)
+{
+  ofs.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  ofs.open(path);
+}
+
+void Logger::open_segments() {
+  log_segments::remove_all(_file_name);
+
+  _segment = 0;
+  _turn = -1;
+  _segment_turns = 0;
+  _segment_bytes = 0;
+  open(_index, _index_buffer, log_segments::index_path(_file_name));
+  open(_ofs, _buffer, log_segments::segment_path(_file_name, _segment));
+}
+
+// a segment that fails to compress is left plain, which reads just the same
+void Logger::close_segment() {
+  _ofs.close();
+  _index.flush();
+
+  std::string path{log_segments::segment_path(_file_name, _segment)};
+
+  _compressors->submit([path]() { log_segments::compress(path); });
 }
 
 void Logger::log(std::string_view str) {
   _ofs << str;
+  _segment_bytes += str.size();
 
   if (to_console)
     std::cout << str;
 }
 
+void Logger::begin_turn(int turn) {
+  if (!_segments.enabled() || turn == _turn)
+    return;
+
+  _turn = turn;
+
+  bool full{
+    (_segments.max_bytes > 0 && _segment_bytes >= _segments.max_bytes) ||
+    (_segments.max_turns > 0 && _segment_turns >= _segments.max_turns)
+  };
+
+  if (full) {
+    close_segment();
+    _segment++;
+    _segment_turns = 0;
+    _segment_bytes = 0;
+    open(_ofs, _buffer, log_segments::segment_path(_file_name, _segment));
+  }
+
+  _index << turn << ' ' << _segment << ' ' << _segment_bytes << '\n';
+  _segment_turns++;
+}
+
 void Logger::clear() {
   _ofs.close();
-  _ofs.open(_file_name);
+
+  if (!_segments.enabled()) {
+    open(_ofs, _buffer, _file_name);
+
+    return;
+  }
+
+  // nothing may still be compressing a segment about to be deleted
+  _compressors->wait();
+  _index.close();
+  open_segments();
 }
\ No newline at end of file
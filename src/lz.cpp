@@ -0,0 +1,159 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "lz.hpp"
+
+namespace lz {
+  static constexpr int min_match{4};
+  static constexpr int max_offset{0xffff};
+  static constexpr int hash_bits{14};
+
+  static std::uint32_t load32(const char* data) {
+    std::uint32_t value{};
+
+    std::memcpy(&value, data, sizeof(value));
+
+    return value;
+  }
+
+  static std::uint32_t hash(std::uint32_t value) {
+    return value * 2654435761u >> (32 - hash_bits);
+  }
+
+  // the 4 bit length in the token, then 255 per byte until one is smaller
+  static void put_length(std::string& out, std::size_t length) {
+    for (length -= 15; length >= 255; length -= 255)
+      out.push_back((char)255);
+
+    out.push_back((char)length);
+  }
+
+  static void put_sequence(std::string& out, std::string_view literals,
+    std::size_t match, std::size_t offset)
+  {
+    std::size_t match_code{match ? match - min_match : 0};
+    std::uint8_t token(std::min<std::size_t>(literals.size(), 15) << 4 |
+      std::min<std::size_t>(match_code, 15));
+
+    out.push_back((char)token);
+
+    if (literals.size() >= 15)
+      put_length(out, literals.size());
+
+    out.append(literals);
+
+    if (!match)
+      return;
+
+    out.push_back((char)(offset & 0xff));
+    out.push_back((char)(offset >> 8));
+
+    if (match_code >= 15)
+      put_length(out, match_code);
+  }
+
+  void compress(std::string_view input, std::string& out) {
+    std::array<std::uint32_t, 1 << hash_bits> last{};
+    const std::size_t size{input.size()};
+    std::size_t anchor{0}; // start of the pending literals
+    std::size_t pos{0};
+
+    // positions are stored plus one so zero means none
+    while (pos + min_match <= size) {
+      std::uint32_t prefix{load32(input.data() + pos)};
+      std::uint32_t& slot{last[hash(prefix)]};
+      std::size_t candidate{slot};
+
+      slot = pos + 1;
+
+      if (!candidate || pos + 1 - candidate > max_offset ||
+        load32(input.data() + candidate - 1) != prefix)
+      {
+        pos++;
+
+        continue;
+      }
+
+      candidate--;
+
+      std::size_t match{min_match};
+
+      while (pos + match < size && input[candidate + match] == input[pos + match])
+        match++;
+
+      put_sequence(out, input.substr(anchor, pos - anchor), match,
+        pos - candidate);
+
+      pos += match;
+      anchor = pos;
+    }
+
+    // the stream always ends with a literal only sequence, maybe empty
+    put_sequence(out, input.substr(anchor), 0, 0);
+  }
+
+  static bool get_length(std::string_view input, std::size_t& pos,
+    std::size_t& length)
+  {
+    std::uint8_t byte{};
+
+    do {
+      if (pos >= input.size())
+        return false;
+
+      byte = input[pos++];
+      length += byte;
+    } while (byte == 255);
+
+    return true;
+  }
+
+  bool decompress(std::string_view input, std::string& out) {
+    const std::size_t start{out.size()};
+    std::size_t pos{0};
+
+    while (pos < input.size()) {
+      std::uint8_t token(input[pos++]);
+      std::size_t literals(token >> 4u);
+
+      if (literals == 15 && !get_length(input, pos, literals))
+        return false;
+
+      if (literals > input.size() - pos)
+        return false;
+
+      out.append(input.substr(pos, literals));
+      pos += literals;
+
+      // only the last sequence has no match
+      if (pos == input.size())
+        return true;
+
+      if (input.size() - pos < 2)
+        return false;
+
+      std::size_t offset{(std::uint8_t)input[pos] |
+        (std::size_t)(std::uint8_t)input[pos + 1] << 8};
+      std::size_t match{token & 15u};
+
+      pos += 2;
+
+      if (match == 15 && !get_length(input, pos, match))
+        return false;
+
+      match += min_match;
+
+      if (!offset || offset > out.size() - start)
+        return false;
+
+      // byte by byte, as a match may overlap what it copies
+      std::size_t from{out.size() - offset};
+
+      for (std::size_t i{0}; i < match; i++)
+        out.push_back(out[from + i]);
+    }
+
+    return true;
+  }
+}
\ No newline at end of file
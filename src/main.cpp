@@ -1,9 +1,16 @@
 #include <SFML/Window/Keyboard.hpp>
 #include <SFML/Graphics.hpp>
-#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
 #include <list>
 #include <fstream>
 #include <iostream>
+#include <filesystem>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <cctype>
+#include <cmath>
 
 #include "config.h"
 #include "util.hpp"
@@ -11,106 +18,167 @@
 #include "tile_map.hpp"
 #include "logger.hpp"
 #include "bunny_manager.hpp"
+#include "event_consumers.hpp"
+#include "room_generator.hpp"
+#include "walk_map.hpp"
+#include "alloc_counter.hpp"
+#include "tile_raster.hpp"
+#include "frame_exporter.hpp"
+#include "camera.hpp"
+#include "map_renderer.hpp"
+#include "lifetime_recorder.hpp"
+#include "genealogy.hpp"
+#include "differential.hpp"
+#include "domain_coordinator.hpp"
+#include "telemetry.hpp"
+#include "hybrid_world.hpp"
+#include "world_batch.hpp"
+#include "locality_bench.hpp"
+#include "log_segments.hpp"
+#include "memory_usage.hpp"
 
 static const TileType floor_tile{TileType::dirt};
+static const TileType wall_tile{TileType::wall};
 static const char *const win_title{"Bunny Simulator"};
 static const char *const out_file_name{"output.txt"};
+static const int max_fps{60};
+static const float zoom_step{1.25f}; // per mouse wheel notch
+static const float pan_step{0.125f}; // fraction of the window per key press
+static const int alloc_warm_up_turns{200};
+static const int alloc_check_turns{2000};
+static const int verify_turns{300};
+static const std::vector<int> verify_sizes{8, 16, 33, 80};
+static const int locality_turns{100};
+static const int batch_samples{4}; // worlds also run one at a time
+static const int survival_seeds{40};
+static const int survival_turns{200};
+static const int survival_size{80};
+static const int path_seeds{20};
+static const int path_pairs{200};
 
-static const std::unordered_map<TileType, std::string> tile_type_map {
-  {TileType::dirt, "dirt"},
-  {TileType::white_adult, "white_adult"},
-  {TileType::white_adult_mutant, "white_adult_mutant"},
-  {TileType::white_juvenile, "white_juvenile"},
-  {TileType::white_juvenile_mutant, "white_juvenile_mutant"},
-  {TileType::brown_adult, "brown_adult"},
-  {TileType::brown_adult_mutant, "brown_adult_mutant"},
-  {TileType::brown_juvenile, "brown_juvenile"},
-  {TileType::brown_juvenile_mutant, "brown_juvenile_mutant"},
-  {TileType::black_adult, "black_adult"},
-  {TileType::black_adult_mutant, "black_adult_mutant"},
-  {TileType::black_juvenile, "black_juvenile"},
-  {TileType::black_juvenile_mutant, "black_juvenile_mutant"},
-  {TileType::spotted_adult, "spotted_adult"},
-  {TileType::spotted_adult_mutant, "spotted_adult_mutant"},
-  {TileType::spotted_juvenile, "spotted_juvenile"},
-  {TileType::spotted_juvenile_mutant, "spotted_juvenile_mutant"}
+// rule policies the viewer and the export can run, picked with --rules
+enum class RulePolicy {
+  standard,
+  seeking,
+  grazing
 };
 
-typedef std::unordered_map<
-  TileType,
-  std::pair<sf::Texture, sf::Sprite>
-> tile_sprite_map_t;
+// calls fn with a value of the policy's rules type
+template<typename F>
+static auto with_rules(RulePolicy policy, F&& fn) {
+  switch (policy) {
+    case RulePolicy::seeking:
+      return fn(rules::Seeking{});
 
-static std::string get_tile_dir(TileType tile_type) {
-  std::string dir("resources/tiles/");
+    case RulePolicy::grazing:
+      return fn(rules::Grazing{});
 
-  dir.append(tile_type_map.at(tile_type));
-  dir.append(".png");
-
-  return dir;
+    default:
+      return fn(rules::Default{});
+  }
 }
 
-static void resize_sprite(sf::Sprite& sprite, int width, int height) {
-  auto size{sprite.getTexture()->getSize()};
+struct DomainOptions {
+  int workers{};
+  Transport transport{Transport::shm};
+  int turns{1000};
+};
 
-  sprite.setScale((float)width / size.x, (float)height / size.y);
-}
+struct HybridOptions {
+  bool enabled{};
+  Resolution resolution{Resolution::adaptive};
+  int turns{1000};
+};
 
-static void init_tile_sprite_map(tile_sprite_map_t& tile_sprite_map,
-  int tile_size)
-{
-  for (int i{0}; i < (int)TileType::end; i++) {
-    TileType tile_type{(TileType)i};
+struct BatchOptions {
+  int worlds{}; // none unless asked for
+  int turns{1000};
+};
 
-    auto ret{tile_sprite_map.insert(
-      {tile_type, {sf::Texture(), sf::Sprite()}})
-    };
-    
-    sf::Texture& tex{ret.first->second.first};
+struct MemoryOptions {
+  MemoryBudget budget{};
+  bool report{}; // printed on exit
+};
 
-    if (!tex.loadFromFile(get_tile_dir(tile_type)))
-      exit(1);
+struct ExportOptions {
+  std::string dir{};
+  int frames{1000};
+  int tile_px{2}; // pixels per cell
+  FrameFormat format{FrameFormat::png};
+};
 
-    sf::Sprite& sprite{ret.first->second.second};
+template<typename Rules>
+static void collect_memory(MemoryReport& report,
+  const BasicBunnyManager<Rules>& bunny_manager, const TileMap& tile_map,
+  const Logger* logger)
+{
+  report.clear();
+  bunny_manager.report_memory(report);
+  report.add("tile map", tile_map.memory_bytes());
 
-    sprite.setTexture(tex);
-    resize_sprite(sprite, tile_size, tile_size);
-  }
+  if (logger)
+    report.add("logger", logger->memory_bytes());
 }
 
-static void draw_tile_map(sf::RenderTexture& tex, TileMap& tile_map,
-  tile_sprite_map_t& tile_sprite_map)
+// Applies the budget's policy once the accounted memory passes it. Returns
+// true, after reporting where the memory went, when the run has to stop.
+// The caller keeps report across turns so its entries are not reallocated.
+template<typename Rules>
+static bool enforce_budget(const MemoryBudget& budget, MemoryReport& report,
+  BasicBunnyManager<Rules>& bunny_manager, const TileMap& tile_map,
+  const Logger* logger)
 {
-  for (const auto& tile : tile_map.modified_tiles()) {
-    int r{tile.first};
-    int c{tile.second};
+  if (!budget.enabled())
+    return false;
 
-    TileType tile_type{(TileType)tile_map.get_tile(c, r)};
+  collect_memory(report, bunny_manager, tile_map, logger);
 
-    if (tile_type != floor_tile) {
-      sf::Sprite& sprite{tile_sprite_map.at(floor_tile).second };
+  if (!budget.over(report.total()))
+    return false;
 
-      sprite.setPosition(c * tile_map.tile_size(), r * tile_map.tile_size());
-      tex.draw(sprite);
-    }
+  if (budget.policy() != MemoryPolicy::abort) {
+    if (budget.policy() == MemoryPolicy::cull)
+      bunny_manager.cull(bunny_manager.bunnies().size() / 2);
 
-    sf::Sprite& sprite{tile_sprite_map.at(tile_type).second };
+    bunny_manager.compact();
+    collect_memory(report, bunny_manager, tile_map, logger);
 
-    sprite.setPosition(c * tile_map.tile_size(), r * tile_map.tile_size());
-    tex.draw(sprite);
+    if (!budget.over(report.total()))
+      return false;
   }
 
-  tex.display();
-  tile_map.reset_modified_tiles();
+  std::cerr << "Memory budget exceeded on turn " << bunny_manager.turn() <<
+    ":\n";
+
+  report.print(std::cerr);
+
+  return true;
 }
 
+template<typename Rules>
+static void print_memory(const BasicBunnyManager<Rules>& bunny_manager,
+  const TileMap& tile_map, const Logger* logger)
+{
+  MemoryReport report{};
+
+  collect_memory(report, bunny_manager, tile_map, logger);
+  std::cout << "Memory on turn " << bunny_manager.turn() << ":\n";
+  report.print(std::cout);
+}
+
+// the window fits the map at its tile size but no larger than the screen;
+// the camera pans and zooms over bigger maps
 static void init_win(sf::RenderWindow& win, TileMap& tile_map,
   bool full_screen = false, char const *title = win_title)
 {
   auto get_win_size = [&tile_map]() {
+    sf::VideoMode desktop{sf::VideoMode::getDesktopMode()};
+
     return sf::Vector2i(
-      tile_map.width() * tile_map.tile_size(),
-      tile_map.height() * tile_map.tile_size()
+      std::min(tile_map.width() * tile_map.tile_size(),
+        (int)desktop.width * 9 / 10),
+      std::min(tile_map.height() * tile_map.tile_size(),
+        (int)desktop.height * 9 / 10)
     );
   };
 
@@ -128,6 +196,8 @@ static void init_win(sf::RenderWindow& win, TileMap& tile_map,
       sf::VideoMode(win_size.x, win_size.y),
       win_title
     );
+
+  win.setFramerateLimit(max_fps);
 }
 
 static void init_iterations_text(sf::Text& iterations_text, sf::Font& font) {
@@ -137,24 +207,46 @@ static void init_iterations_text(sf::Text& iterations_text, sf::Font& font) {
   iterations_text.setPosition(10, 10);
 }
 
+// a line in the text log's format, with the bunny's cell
+static void print_bunny(const Bunny& bunny) {
+  std::cout << (bunny.infected() ? "Infected bunny " : "Bunny ") <<
+    bunny.name() << " (" << bunny.age() << " years old, " <<
+    (bunny.gender() == Gender::male ? "male" : "female") << ", " <<
+    bunny_colour_str[(int)bunny.colour()] << ") at (" << bunny.pos.x <<
+    ", " << bunny.pos.y << ")\n";
+}
+
+static void print_filter(const BunnyFilter& filter) {
+  std::cout << "Inspecting " <<
+    (filter.infected ? *filter.infected ? "infected " : "healthy " : "") <<
+    (filter.colour ? bunny_colour_str[(int)*filter.colour] : "any colour") <<
+    (filter.min_age > 0 ? " adults" :
+      filter.max_age < rules::Default::adult_age ? " juveniles" : " bunnies")
+    << "\n";
+}
+
+template<typename Rules>
 static void game_loop(sf::RenderWindow& win, TileMap& tile_map,
-  tile_sprite_map_t& tile_sprite_map)
+  const WalkMap* walk_map, const std::vector<EventConsumer*>& recorders,
+  const SegmentOptions& segments, const MemoryOptions& memory, bool roster)
 {
-  sf::RenderTexture screen_tex{};
-  
-  if (!screen_tex.create(win.getSize().x, win.getSize().y))
+  sf::Vector2i win_size(win.getSize());
+  Camera camera(sf::Vector2i(tile_map.width(), tile_map.height()), win_size);
+  MapRenderer map_renderer{};
+
+  if (!map_renderer.load(tile_map.tile_size(), floor_tile))
     exit(1);
 
-  sf::Sprite screen_sprite(screen_tex.getTexture());
+  map_renderer.resize(win_size);
 
+  // only the parts of the map that changed are uploaded to the texture
   auto update_screen = [&]() {
     win.clear(sf::Color::Black);
-    draw_tile_map(screen_tex, tile_map, tile_sprite_map);
-    win.draw(screen_sprite);
+    map_renderer.sync(tile_map);
+    map_renderer.render(camera);
+    win.draw(map_renderer.sprite());
   };
 
-  update_screen();
-
   int iterations{0};
   sf::Text iterations_text{};
   sf::Font font;
@@ -169,58 +261,964 @@ static void game_loop(sf::RenderWindow& win, TileMap& tile_map,
     win.draw(iterations_text);
   };
 
-  Logger logger(out_file_name);
-  BunnyManager bunny_manager(tile_map, floor_tile, logger); 
+  Logger logger(out_file_name, false, segments);
+  TilePainter tile_painter(tile_map);
+  TextLogger text_logger(logger, roster);
 
-  bool log_to_console{false};
-  
-  while (win.isOpen()) {
-    sf::Event event{};
+  std::vector<EventConsumer*> consumers{&tile_painter, &text_logger};
+
+  consumers.insert(consumers.end(), recorders.begin(), recorders.end());
+
+  BasicBunnyManager<Rules> bunny_manager(tile_map, floor_tile, consumers,
+    walk_map);
+
+  MemoryReport memory_report{}; // refilled by every turn's budget check
+
+  bool panning{false};
+  sf::Vector2i pan_from{};
+
+  // a left click inspects the bunny on a cell and a left drag the bunnies
+  // matching the filter in a rectangle, both by their map cells
+  bool selecting{false};
+  sf::Vector2i select_from{};
+  BunnyFilter filter{};
+  std::vector<BunnyHandle> inspected{};
+
+  auto cell_at = [&](int x, int y) {
+    sf::Vector2f world{camera.to_world(sf::Vector2f(x, y))};
+
+    return sf::Vector2i(std::floor(world.x), std::floor(world.y));
+  };
+
+  auto inspect = [&](sf::Vector2i from, sf::Vector2i to) {
+    if (from == to) {
+      BunnyHandle handle{bunny_manager.bunny_at(from)};
+
+      if (handle.valid())
+        print_bunny(bunny_manager.bunnies()[handle]);
+
+      return;
+    }
+
+    sf::IntRect rect(std::min(from.x, to.x), std::min(from.y, to.y),
+      std::abs(from.x - to.x) + 1, std::abs(from.y - to.y) + 1);
+
+    bunny_manager.bunnies_in(rect, filter, inspected);
 
-    while (win.pollEvent(event)) {
-      if (event.type == sf::Event::Closed)
-        win.close();
-      
-      else if (event.type == sf::Event::KeyPressed) {
-        if (event.key.code == sf::Keyboard::T) {
-          if (!bunny_manager.next_turn())
-            iterations += 1;
+    std::cout << inspected.size() << " bunnies from (" << rect.left << ", "
+      << rect.top << ") to (" << rect.left + rect.width - 1 << ", " <<
+      rect.top + rect.height - 1 << "):\n";
+
+    for (const auto handle : inspected)
+      print_bunny(bunny_manager.bunnies()[handle]);
+  };
+
+  // returns whether the event changed the map, the view or the text
+  auto handle_event = [&](const sf::Event& event) {
+    if (event.type == sf::Event::Closed)
+      win.close();
+
+    else if (event.type == sf::Event::Resized) {
+      win_size = sf::Vector2i(event.size.width, event.size.height);
+      win.setView(sf::View(sf::FloatRect(0, 0, win_size.x, win_size.y)));
+      camera.resize(win_size);
+      map_renderer.resize(win_size);
+
+      return true;
+    }
+
+    // the window contents may need repainting after being covered
+    else if (event.type == sf::Event::GainedFocus)
+      return true;
+
+    else if (event.type == sf::Event::MouseWheelScrolled) {
+      camera.zoom_at(
+        sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y),
+        event.mouseWheelScroll.delta > 0 ? zoom_step : 1 / zoom_step
+      );
+
+      return true;
+    }
+
+    else if (event.type == sf::Event::MouseButtonPressed &&
+      event.mouseButton.button == sf::Mouse::Left)
+    {
+      selecting = true;
+      select_from = cell_at(event.mouseButton.x, event.mouseButton.y);
+    }
+
+    else if (event.type == sf::Event::MouseButtonPressed) {
+      panning = true;
+      pan_from = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+    }
+
+    else if (event.type == sf::Event::MouseButtonReleased &&
+      event.mouseButton.button == sf::Mouse::Left)
+    {
+      if (selecting)
+        inspect(select_from,
+          cell_at(event.mouseButton.x, event.mouseButton.y));
+
+      selecting = false;
+    }
+
+    else if (event.type == sf::Event::MouseButtonReleased)
+      panning = false;
+
+    else if (event.type == sf::Event::MouseMoved && panning) {
+      sf::Vector2i to(event.mouseMove.x, event.mouseMove.y);
+
+      camera.pan(sf::Vector2f(pan_from.x - to.x, pan_from.y - to.y));
+      pan_from = to;
+
+      return true;
+    }
+    
+    else if (event.type == sf::Event::KeyPressed) {
+      if (event.key.code == sf::Keyboard::T) {
+        if (!bunny_manager.next_turn())
+          iterations += 1;
+
+        if (enforce_budget(memory.budget, memory_report, bunny_manager,
+          tile_map, &logger))
+        {
+          win.close();
         }
+      }
+
+      else if (event.key.code == sf::Keyboard::R) {
+        logger.clear();
+        bunny_manager.reset();
+        iterations = 0;
+      }
+
+      else if (event.key.code == sf::Keyboard::C) {
+        logger.to_console = !logger.to_console;
+
+        return false;
+      }
+
+      else if (event.key.code == sf::Keyboard::F)
+        camera.fit();
+
+      // 1 to 4 pick a colour to inspect, again for any
+      else if (event.key.code >= sf::Keyboard::Num1 &&
+        event.key.code <= sf::Keyboard::Num4)
+      {
+        BunnyColour colour{event.key.code - sf::Keyboard::Num1};
+
+        filter.colour = filter.colour == colour ?
+          std::nullopt : std::optional(colour);
+
+        print_filter(filter);
 
-        else if (event.key.code == sf::Keyboard::R) {
-          bunny_manager.reset();
-          iterations = 0;
+        return false;
+      }
+
+      // cycles any, infected and healthy
+      else if (event.key.code == sf::Keyboard::I) {
+        filter.infected = !filter.infected ? std::optional(true) :
+          *filter.infected ? std::optional(false) : std::nullopt;
+
+        print_filter(filter);
+
+        return false;
+      }
+
+      // cycles any age, adults and juveniles
+      else if (event.key.code == sf::Keyboard::A) {
+        if (filter.min_age == 0 && filter.max_age == BunnyFilter{}.max_age)
+          filter.min_age = rules::Default::adult_age;
 
-          logger.clear();
+        else if (filter.min_age > 0) {
+          filter.min_age = 0;
+          filter.max_age = rules::Default::adult_age - 1;
         }
 
-        else if (event.key.code == sf::Keyboard::C)
-          logger.to_console = !logger.to_console;
+        else
+          filter = BunnyFilter{filter.colour, filter.infected};
+
+        print_filter(filter);
+
+        return false;
       }
+
+      else if (event.key.code == sf::Keyboard::Left)
+        camera.pan(sf::Vector2f(-win_size.x * pan_step, 0));
+
+      else if (event.key.code == sf::Keyboard::Right)
+        camera.pan(sf::Vector2f(win_size.x * pan_step, 0));
+
+      else if (event.key.code == sf::Keyboard::Up)
+        camera.pan(sf::Vector2f(0, -win_size.y * pan_step));
+
+      else if (event.key.code == sf::Keyboard::Down)
+        camera.pan(sf::Vector2f(0, win_size.y * pan_step));
+
+      else
+        return false;
+
+      return true;
     }
 
+    return false;
+  };
+
+  // Frames are only drawn when an event changed something, and the loop
+  // sleeps in waitEvent otherwise so an idle viewer uses no CPU. Bursts of
+  // events (held keys, drags) are drained before drawing once.
+  bool redraw{true};
+
+  while (win.isOpen()) {
+    sf::Event event{};
+
+    if (!redraw && win.waitEvent(event))
+      redraw = handle_event(event);
+
+    while (win.pollEvent(event))
+      redraw = handle_event(event) || redraw;
+
+    if (!redraw || !win.isOpen())
+      continue;
+
     update_screen();
     update_ui();
     win.display();
+    redraw = false;
+  }
+
+  if (memory.report)
+    print_memory(bunny_manager, tile_map, &logger);
+}
+
+// Runs turns without a window and fails if any turn after the warm-up
+// allocates. Extinctions are reset outside the measured turns.
+static int check_allocs(TileMap& tile_map, const WalkMap* walk_map) {
+  if (!alloc_counter::enabled()) {
+    std::cerr << "--check-allocs needs a build with BUNNY_ALLOC_CHECK=ON\n";
+
+    return 1;
+  }
+
+  Logger logger(out_file_name);
+  TilePainter tile_painter(tile_map);
+  TextLogger text_logger(logger);
+  StatsCollector stats{};
+
+  BunnyManager bunny_manager(tile_map, floor_tile,
+    {&tile_painter, &text_logger, &stats}, walk_map);
+
+  int failed_turns{0};
+
+  for (int i{0}; i < alloc_warm_up_turns + alloc_check_turns; i++) {
+    std::uint64_t before{alloc_counter::allocations()};
+    bool extinct{bunny_manager.next_turn()};
+
+    tile_map.reset_modified_tiles(); // normally done by drawing
+
+    std::uint64_t allocations{alloc_counter::allocations() - before};
+
+    if (extinct) {
+      bunny_manager.reset();
+      tile_map.reset_modified_tiles();
+
+      continue;
+    }
+
+    if (i >= alloc_warm_up_turns && allocations) {
+      failed_turns++;
+      std::cerr << "Turn " << bunny_manager.turn() << " (population " <<
+        stats.last().population << ") made " << allocations <<
+        " allocations\n";
+    }
+  }
+
+  if (failed_turns) {
+    std::cerr << failed_turns << " of " << alloc_check_turns <<
+      " turns allocated\n";
+
+    return 1;
+  }
+
+  std::cout << "No allocations in " << alloc_check_turns << " turns\n";
+
+  return 0;
+}
+
+// Runs the default and grazing rules from each seed on the default map and
+// fails if fewer than half of the runs of either still have bunnies at the
+// end. Mate seeking is run alongside for comparison only.
+static int check_survival() {
+  auto extinctions = [](auto rules) {
+    int extinct{0};
+
+    for (int seed{1}; seed <= survival_seeds; seed++) {
+      util::seed(seed);
+
+      TileMap tile_map(survival_size, survival_size, 1, (int)floor_tile);
+      BasicBunnyManager<decltype(rules)> manager(tile_map, floor_tile, {});
+
+      for (int turn{0}; turn < survival_turns; turn++) {
+        if (manager.next_turn()) {
+          extinct++;
+
+          break;
+        }
+      }
+    }
+
+    return extinct;
+  };
+
+  const int standard{extinctions(rules::Default{})};
+  const int grazing{extinctions(rules::Grazing{})};
+  const int seeking{extinctions(rules::Seeking{})};
+
+  std::cout << "Died out within " << survival_turns << " turns: " <<
+    standard << " of " << survival_seeds << " runs with the default rules, "
+    << grazing << " grazing, " << seeking << " with mate seeking\n";
+
+  if (std::max(standard, grazing) * 2 > survival_seeds)
+    return 1;
+
+  return 0;
+}
+
+// Searches between random cells of room maps and fails unless BFS and A*
+// agree with a distance field sweep, give unbroken routes that stay off the
+// walls, and find nothing when the goal is a wall. Some routes must bend
+// round a wall or the check proves nothing about obstacles.
+static int check_paths() {
+  int failed{0};
+  int detours{0};
+  std::vector<int> bfs_path{};
+  std::vector<int> a_star_path{};
+  std::vector<int> source(1);
+  path_finding::DistanceField field{};
+
+  auto connected = [](const std::vector<int>& path, int width,
+    const WalkMap& walk_map)
+  {
+    for (std::size_t i{0}; i < path.size(); i++) {
+      if (!walk_map.walkable(path[i]))
+        return false;
+
+      if (i > 0 && std::abs(path[i] % width - path[i - 1] % width) +
+        std::abs(path[i] / width - path[i - 1] / width) != 1)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  for (int seed{1}; seed <= path_seeds; seed++) {
+    util::seed(seed);
+
+    TileMap tile_map(survival_size, survival_size, 1, (int)floor_tile);
+    RoomGenerator room_generator(tile_map.width(), tile_map.height());
+
+    room_generator.gen();
+    room_generator.carve(tile_map, (int)floor_tile, (int)wall_tile);
+
+    WalkMap walk_map(tile_map, (int)wall_tile);
+    const int width{tile_map.width()};
+    const int height{tile_map.height()};
+    const int cells{width * height};
+
+    auto walkable = [&](int cell) { return walk_map.walkable(cell); };
+
+    field.resize(width, height);
+
+    for (int pair{0}; pair < path_pairs; pair++) {
+      int start{util::rnd_range(0, cells - 1)};
+      int goal{util::rnd_range(0, cells - 1)};
+
+      if (!walk_map.walkable(start))
+        continue;
+
+      source[0] = start;
+      field.build(source, walkable);
+
+      int distance{field.distance(goal)};
+      bool by_bfs{path_finding::bfs(width, height, start, goal, walkable,
+        bfs_path)};
+      bool by_a_star{path_finding::a_star(width, height, start, goal,
+        walkable, a_star_path)};
+      bool reachable{distance != path_finding::unreachable};
+
+      bool ok{by_bfs == reachable && by_a_star == reachable};
+
+      if (ok && reachable) {
+        ok = (int)bfs_path.size() == distance + 1 &&
+          (int)a_star_path.size() == distance + 1 &&
+          bfs_path.front() == start && bfs_path.back() == goal &&
+          a_star_path.front() == start && a_star_path.back() == goal &&
+          connected(bfs_path, width, walk_map) &&
+          connected(a_star_path, width, walk_map);
+
+        if (distance > std::abs(goal % width - start % width) +
+          std::abs(goal / width - start / width))
+        {
+          detours++;
+        }
+      }
+
+      if (!ok) {
+        failed++;
+        std::cerr << "Seed " << seed << ": route from " << start <<
+          " to " << goal << " disagrees (distance " << distance << ", bfs " <<
+          bfs_path.size() << " cells, a* " << a_star_path.size() <<
+          " cells)\n";
+      }
+    }
   }
+
+  std::cout << "Searches on " << path_seeds << " room maps: " << failed <<
+    " failed, " << detours << " routes went round walls\n";
+
+  return failed || !detours ? 1 : 0;
+}
+
+// Advances the simulation headless and writes a frame per turn. The
+// simulation runs on this thread while the exporter's workers rasterise and
+// encode earlier turns.
+template<typename Rules>
+static int export_frames(TileMap& tile_map, const WalkMap* walk_map,
+  const std::vector<EventConsumer*>& recorders, const ExportOptions& options,
+  const MemoryOptions& memory)
+{
+  TileRaster raster{};
+
+  if (!raster.load(options.tile_px, floor_tile))
+    return 1;
+
+  std::filesystem::create_directories(options.dir);
+
+  TilePainter tile_painter(tile_map);
+  std::vector<EventConsumer*> consumers{&tile_painter};
+
+  consumers.insert(consumers.end(), recorders.begin(), recorders.end());
+
+  BasicBunnyManager<Rules> bunny_manager(tile_map, floor_tile, consumers,
+    walk_map);
+  FrameExporter exporter(raster, tile_map.width(), tile_map.height(),
+    options.dir, options.format);
+  MemoryReport memory_report{};
+
+  auto start{std::chrono::steady_clock::now()};
+
+  int exported{0};
+
+  for (int frame{0}; frame < options.frames; frame++) {
+    if (frame > 0 && bunny_manager.next_turn())
+      bunny_manager.reset();
+
+    if (enforce_budget(memory.budget, memory_report, bunny_manager, tile_map,
+      nullptr))
+    {
+      break;
+    }
+
+    tile_map.reset_modified_tiles();
+    exporter.capture(tile_map, frame);
+    exported++;
+  }
+
+  exporter.finish();
+
+  std::chrono::duration<double> elapsed{
+    std::chrono::steady_clock::now() - start
+  };
+
+  std::cout << "Exported " << exported << " frames in " <<
+    elapsed.count() << "s (" << exported / elapsed.count() <<
+    " frames/s)\n";
+
+  if (exporter.failed()) {
+    std::cerr << exporter.failed() << " frames could not be written\n";
+
+    return 1;
+  }
+
+  if (memory.report)
+    print_memory(bunny_manager, tile_map, nullptr);
+
+  // stopped by the memory budget
+  if (exported < options.frames)
+    return 1;
+
+  return 0;
+}
+
+// Steps a world split across worker processes. The classic bunny limit and
+// initial spawn are for an 80 by 80 map, so both are scaled by the world's
+// area to keep bigger worlds as crowded.
+static int run_domains(int size, const DomainOptions& options) {
+  const double area{size * (double)size / (80 * 80)};
+  const int bunny_limit(std::max(2.0, rules::Classic::bunny_limit * area));
+  const int initial_spawn(std::max(1.0, rules::Classic::initial_spawn * area));
+
+  DomainCoordinator coordinator(size, size, options.workers,
+    options.transport, bunny_limit, initial_spawn);
+
+  if (!coordinator.started()) {
+    std::cerr << "Could not start the worker processes\n";
+
+    return 1;
+  }
+
+  auto start{std::chrono::steady_clock::now()};
+
+  for (int turn{0}; turn < options.turns; turn++) {
+    if (coordinator.next_turn())
+      coordinator.reset();
+
+    if (coordinator.failed()) {
+      std::cerr << "A worker process exited during turn " <<
+        coordinator.total().turn + 1 << "\n";
+
+      return 1;
+    }
+  }
+
+  std::chrono::duration<double> elapsed{
+    std::chrono::steady_clock::now() - start
+  };
+
+  const TurnStats& total{coordinator.total()};
+
+  std::cout << options.turns << " turns on " << coordinator.workers() <<
+    " workers in " << elapsed.count() << "s (" <<
+    options.turns / elapsed.count() << " turns/s)\n";
+
+  std::cout << "Turn " << total.turn << ": population " << total.population
+    << ", " << total.births << " births, " << total.deaths << " deaths, " <<
+    total.infections << " infections, " << total.culls << " culls\n";
+
+  return 0;
+}
+
+// Steps a world mixing agents and cohorts, scaled like run_domains.
+static int run_hybrid(int size, const HybridOptions& options) {
+  const double area{size * (double)size / (80 * 80)};
+  const int bunny_limit(std::max(2.0, rules::Classic::bunny_limit * area));
+  const int initial_spawn(std::max(1.0, rules::Classic::initial_spawn * area));
+
+  HybridWorld world(size, size, bunny_limit, initial_spawn,
+    options.resolution);
+
+  auto start{std::chrono::steady_clock::now()};
+
+  for (int turn{0}; turn < options.turns; turn++) {
+    if (world.next_turn())
+      world.reset();
+  }
+
+  std::chrono::duration<double> elapsed{
+    std::chrono::steady_clock::now() - start
+  };
+
+  const HybridStats& total{world.total()};
+
+  std::cout << options.turns << " turns in " << elapsed.count() << "s (" <<
+    options.turns / elapsed.count() << " turns/s)\n";
+
+  std::cout << "Turn " << total.turn << ": population " << total.population
+    << " (" << total.infected << " infected), " << total.agent_blocks <<
+    " agent and " << total.cohort_blocks << " cohort blocks\n";
+
+  std::cout << total.births << " births, " << total.deaths << " deaths, " <<
+    total.infections << " infections, " << total.culls << " culls\n";
+
+  return 0;
+}
+
+// Steps many worlds a batch of WorldBatch::lanes at a time under the
+// classic rules, unscaled so a few of them can be stepped one BunnyManager
+// at a time for comparison. Batch n is seeded with n, counting from 1.
+static int run_batch(int size, const BatchOptions& options) {
+  std::vector<WorldResult> results{};
+  auto start{std::chrono::steady_clock::now()};
+
+  for (int first{0}; first < options.worlds; first += WorldBatch::lanes) {
+    const int worlds{std::min(WorldBatch::lanes, options.worlds - first)};
+
+    WorldBatch batch(size, first / WorldBatch::lanes + 1,
+      std::vector<WorldParams>(worlds));
+
+    for (int turn{0}; turn < options.turns; turn++)
+      batch.next_turn();
+
+    std::vector<WorldResult> batch_results{batch.results()};
+
+    results.insert(results.end(), batch_results.begin(), batch_results.end());
+  }
+
+  std::chrono::duration<double> batch_elapsed{
+    std::chrono::steady_clock::now() - start
+  };
+
+  const int samples{std::min(batch_samples, options.worlds)};
+
+  start = std::chrono::steady_clock::now();
+
+  for (int sample{0}; sample < samples; sample++) {
+    util::seed(sample + 1);
+
+    TileMap tile_map(size, size, 1, (int)floor_tile);
+    BasicBunnyManager<rules::Classic> manager(tile_map, floor_tile, {});
+
+    for (int turn{0}; turn < options.turns; turn++) {
+      if (manager.next_turn())
+        manager.reset();
+    }
+  }
+
+  std::chrono::duration<double> single_elapsed{
+    std::chrono::steady_clock::now() - start
+  };
+
+  const double batch_rate{
+    options.worlds * (double)options.turns / batch_elapsed.count()
+  };
+
+  const double single_rate{
+    samples * (double)options.turns / single_elapsed.count()
+  };
+
+  std::cout << options.worlds << " worlds of " << options.turns <<
+    " turns in " << batch_elapsed.count() << "s (" << batch_rate <<
+    " world-turns/s, " << batch_rate / single_rate << " times the " <<
+    single_rate << " of one world at a time)\n";
+
+  WorldResult total{};
+  int min_population{results.front().population};
+  int max_population{min_population};
+
+  for (const WorldResult& result : results) {
+    total.population += result.population;
+    total.infected += result.infected;
+    total.births += result.births;
+    total.deaths += result.deaths;
+    total.infections += result.infections;
+    total.culls += result.culls;
+    total.extinctions += result.extinctions;
+    min_population = std::min(min_population, result.population);
+    max_population = std::max(max_population, result.population);
+  }
+
+  const double worlds(options.worlds);
+
+  std::cout << "Turn " << options.turns << ": population " <<
+    total.population / worlds << " on average (" << min_population << " to "
+    << max_population << "), " << total.infected / worlds << " infected, " <<
+    total.extinctions << " extinctions\n";
+
+  std::cout << total.births / worlds << " births, " << total.deaths / worlds <<
+    " deaths, " << total.infections / worlds << " infections, " <<
+    total.culls / worlds << " culls per world\n";
+
+  return 0;
+}
+
+static void print_lineage(Genealogy& genealogy) {
+  std::cout << "Births: " << genealogy.births() << " (" <<
+    genealogy.memory_bytes() / 1024 << " KiB of lineage)\n";
+
+  std::cout << "Founder lines: " << genealogy.lines() << "\n";
+
+  int line{genealogy.dominant_line()};
+
+  if (line == Genealogy::no_line)
+    return;
+
+  Genealogy::Descendants descendants{
+    genealogy.descendants(genealogy.founder(line))
+  };
+
+  std::cout << "Dominant line: " << line << " with " <<
+    genealogy.line_share(line) * 100 << "% of " << genealogy.population() <<
+    " living bunnies, " << descendants.total << " descendants (" <<
+    descendants.infected << " infected)\n";
 }
 
 int main(int argc, char *argv[]) {
+  bool gen_rooms{false};
+  bool alloc_check{false};
+  int size{80};
+  ExportOptions export_options{};
+  std::string lifetimes_file{};
+  bool track_lineage{false};
+  int verify_seeds{0};
+  int bench_turns{0};
+  SegmentOptions segment_options{};
+  int find_turn{-1};
+  MemoryOptions memory_options{};
+  std::size_t memory_budget{0};
+  MemoryPolicy memory_policy{MemoryPolicy::compact};
+  DomainOptions domain_options{};
+  std::string telemetry_name{};
+  HybridOptions hybrid_options{};
+  BatchOptions batch_options{};
+  bool roster{true};
+  RulePolicy rule_policy{RulePolicy::standard};
+  bool survival_check{false};
+  bool path_check{false};
+
+  for (int i{1}; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    bool has_value{i + 1 < argc};
+
+    if (arg == "--rooms")
+      gen_rooms = true;
+
+    else if (arg == "--check-allocs")
+      alloc_check = true;
+
+    else if (arg == "--check-survival")
+      survival_check = true;
+
+    else if (arg == "--check-paths")
+      path_check = true;
+
+    else if (arg == "--rules" && has_value) {
+      std::string_view value{argv[++i]};
+
+      rule_policy = value == "seeking" ? RulePolicy::seeking :
+        value == "grazing" ? RulePolicy::grazing : RulePolicy::standard;
+    }
+
+    else if (arg == "--size" && has_value)
+      size = std::max(1, std::atoi(argv[++i]));
+
+    else if (arg == "--export" && has_value)
+      export_options.dir = argv[++i];
+
+    else if (arg == "--frames" && has_value)
+      export_options.frames = std::max(1, std::atoi(argv[++i]));
+
+    else if (arg == "--scale" && has_value)
+      export_options.tile_px = std::max(1, std::atoi(argv[++i]));
+
+    else if (arg == "--ppm")
+      export_options.format = FrameFormat::ppm;
+
+    else if (arg == "--lifetimes" && has_value)
+      lifetimes_file = argv[++i];
+
+    else if (arg == "--lineage")
+      track_lineage = true;
+
+    else if (arg == "--no-roster")
+      roster = false;
+
+    else if (arg == "--telemetry") {
+      telemetry_name = telemetry::default_name;
+
+      if (has_value && argv[i + 1][0] == '/')
+        telemetry_name = argv[++i];
+    }
+
+    else if (arg == "--workers" && has_value)
+      domain_options.workers = std::max(1, std::atoi(argv[++i]));
+
+    else if (arg == "--transport" && has_value)
+      domain_options.transport = std::string_view(argv[++i]) == "socket" ?
+        Transport::socket : Transport::shm;
+
+    else if (arg == "--turns" && has_value) {
+      domain_options.turns = std::max(1, std::atoi(argv[++i]));
+      hybrid_options.turns = domain_options.turns;
+      batch_options.turns = domain_options.turns;
+    }
+
+    else if (arg == "--hybrid") {
+      hybrid_options.enabled = true;
+
+      std::string_view value{has_value ? argv[i + 1] : ""};
+
+      if (value == "agents" || value == "cohorts") {
+        hybrid_options.resolution = value == "agents" ?
+          Resolution::agents : Resolution::cohorts;
+
+        i++;
+      }
+    }
+
+    else if (arg == "--batch") {
+      batch_options.worlds = WorldBatch::lanes;
+
+      if (has_value && std::isdigit(argv[i + 1][0]))
+        batch_options.worlds = std::max(1, std::atoi(argv[++i]));
+    }
+
+    else if (arg == "--verify") {
+      verify_seeds = 20;
+
+      if (has_value && std::isdigit(argv[i + 1][0]))
+        verify_seeds = std::max(1, std::atoi(argv[++i]));
+    }
+
+    else if (arg == "--segment-mb" && has_value) {
+      segment_options.max_bytes =
+        std::max(1, std::atoi(argv[++i])) * std::int64_t(1 << 20);
+    }
+
+    else if (arg == "--segment-turns" && has_value)
+      segment_options.max_turns = std::max(1, std::atoi(argv[++i]));
+
+    else if (arg == "--find-turn" && has_value)
+      find_turn = std::max(0, std::atoi(argv[++i]));
+
+    else if (arg == "--memory")
+      memory_options.report = true;
+
+    else if (arg == "--memory-budget" && has_value) {
+      memory_budget =
+        std::max(1, std::atoi(argv[++i])) * std::size_t(1 << 20);
+    }
+
+    else if (arg == "--memory-policy" && has_value) {
+      std::string_view value{argv[++i]};
+
+      memory_policy = value == "cull" ? MemoryPolicy::cull :
+        value == "abort" ? MemoryPolicy::abort : MemoryPolicy::compact;
+    }
+
+    else if (arg == "--bench-locality") {
+      bench_turns = locality_turns;
+
+      if (has_value && std::isdigit(argv[i + 1][0]))
+        bench_turns = std::max(1, std::atoi(argv[++i]));
+    }
+  }
+
+  // seeds 1 to n so a reported divergence can be rerun
+  if (verify_seeds) {
+    std::vector<std::uint32_t> seeds(verify_seeds);
+
+    std::iota(seeds.begin(), seeds.end(), 1);
+
+    return differential::stress(seeds, verify_sizes, verify_turns, std::cout);
+  }
+
+  if (survival_check)
+    return check_survival();
+
+  if (path_check)
+    return check_paths();
+
+  if (memory_budget)
+    memory_options.budget = MemoryBudget(memory_budget, memory_policy);
+
+  if (find_turn >= 0) {
+    std::string lines{};
+
+    if (!log_segments::read_turn(out_file_name, find_turn, lines)) {
+      std::cerr << "Turn " << find_turn << " is not in the segment index\n";
+
+      return 1;
+    }
+
+    std::cout << lines;
+
+    return 0;
+  }
+
+  if (bench_turns)
+    return locality_bench::run(size, bench_turns, std::cout);
+
+  if (domain_options.workers)
+    return run_domains(size, domain_options);
+
+  if (hybrid_options.enabled)
+    return run_hybrid(size, hybrid_options);
+
+  if (batch_options.worlds)
+    return run_batch(size, batch_options);
+
+  // optional recorders run alongside the viewer or the export
+  std::vector<EventConsumer*> recorders{};
+  std::unique_ptr<LifetimeRecorder> lifetime_recorder{};
+
+  if (!lifetimes_file.empty()) {
+    lifetime_recorder = std::make_unique<LifetimeRecorder>(lifetimes_file,
+      lifetimes_file.ends_with(".csv") ? LifetimeRecorder::Format::csv :
+        LifetimeRecorder::Format::columnar);
+
+    recorders.push_back(lifetime_recorder.get());
+  }
+
+  Genealogy genealogy{};
+
+  if (track_lineage)
+    recorders.push_back(&genealogy);
+
+  std::unique_ptr<TelemetryWriter> telemetry_writer{};
+  std::unique_ptr<TelemetryPublisher> telemetry_publisher{};
+
+  if (!telemetry_name.empty()) {
+    telemetry_writer = std::make_unique<TelemetryWriter>(telemetry_name);
+
+    if (!telemetry_writer->valid()) {
+      std::cerr << "Could not create the telemetry ring " << telemetry_name
+        << "\n";
+
+      return 1;
+    }
+
+    telemetry_publisher =
+      std::make_unique<TelemetryPublisher>(*telemetry_writer);
+
+    recorders.push_back(telemetry_publisher.get());
+  }
+
   TileMap tile_map(
-    80, // width
-    80, // height
+    size, // width
+    size, // height
     16, // tile size
     (int)floor_tile
   );
 
-  tile_sprite_map_t tile_sprite_map{};
+  WalkMap walk_map{};
+
+  if (gen_rooms) {
+    RoomGenerator room_generator(tile_map.width(), tile_map.height());
+
+    room_generator.gen();
+    room_generator.carve(tile_map, (int)floor_tile, (int)wall_tile);
+    walk_map.build(tile_map, (int)wall_tile);
+  }
 
-  init_tile_sprite_map(tile_sprite_map, tile_map.tile_size());
+  if (alloc_check)
+    return check_allocs(tile_map, gen_rooms ? &walk_map : nullptr);
+
+  if (!export_options.dir.empty()) {
+    int result{with_rules(rule_policy, [&](auto rules) {
+      return export_frames<decltype(rules)>(tile_map,
+        gen_rooms ? &walk_map : nullptr, recorders, export_options,
+        memory_options);
+    })};
+
+    if (track_lineage)
+      print_lineage(genealogy);
+
+    return result;
+  }
 
   sf::RenderWindow win{};
   
   init_win(win, tile_map);
-  game_loop(win, tile_map, tile_sprite_map);
+  with_rules(rule_policy, [&](auto rules) {
+    game_loop<decltype(rules)>(win, tile_map,
+      gen_rooms ? &walk_map : nullptr, recorders, segment_options,
+      memory_options, roster);
+  });
+
+  if (track_lineage)
+    print_lineage(genealogy);
 
   return 0;
 }
\ No newline at end of file
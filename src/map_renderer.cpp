@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "map_renderer.hpp"
+
+static int tile_rank(int tile) {
+  if (tile >= (int)TileType::white_adult &&
+    tile <= (int)TileType::spotted_juvenile_mutant)
+      return 3;
+
+  if (tile == (int)TileType::wall)
+    return 2;
+
+  if (tile == (int)TileType::grass)
+    return 1;
+
+  return 0;
+}
+
+bool MapRenderer::load(int tile_px, TileType floor_tile) {
+  return _raster.load(tile_px, floor_tile);
+}
+
+void MapRenderer::resize(sf::Vector2i screen) {
+  _screen = screen;
+  _pixels.assign(screen.x * screen.y * TileRaster::channels, 0);
+  _upload.resize(screen.x * chunk_px * TileRaster::channels);
+  _col_cells.resize(screen.x);
+  _col_px.resize(screen.x);
+  _chunks = sf::Vector2i((screen.x + chunk_px - 1) / chunk_px,
+    (screen.y + chunk_px - 1) / chunk_px);
+  _dirty_chunks.assign(_chunks.x * _chunks.y, 0);
+  _texture.create(screen.x, screen.y);
+  _sprite.setTexture(_texture, true);
+  _drawn = false;
+}
+
+const sf::Sprite& MapRenderer::sprite() const { return _sprite; }
+
+// the most notable of the 2x2 cells below (c, r) in level - 1
+std::uint8_t MapRenderer::merge(int level, int c, int r) const {
+  const auto& below{_levels[level - 1]};
+  sf::Vector2i size{_level_sizes[level - 1]};
+  std::uint8_t best{below[2 * r * size.x + 2 * c]};
+
+  for (int y{2 * r}; y < std::min(2 * r + 2, size.y); y++) {
+    for (int x{2 * c}; x < std::min(2 * c + 2, size.x); x++) {
+      std::uint8_t tile{below[y * size.x + x]};
+
+      if (tile_rank(tile) > tile_rank(best))
+        best = tile;
+    }
+  }
+
+  return best;
+}
+
+void MapRenderer::rebuild(const TileMap& tile_map) {
+  sf::Vector2i size(tile_map.width(), tile_map.height());
+
+  _levels.clear();
+  _level_sizes.clear();
+
+  _levels.emplace_back(size.x * size.y);
+  _level_sizes.push_back(size);
+
+  for (int r{0}; r < size.y; r++) {
+    const auto& row{tile_map.data()[r]};
+
+    for (int c{0}; c < size.x; c++)
+      _levels[0][r * size.x + c] = row[c];
+  }
+
+  while (size.x > 1 || size.y > 1) {
+    size = sf::Vector2i((size.x + 1) / 2, (size.y + 1) / 2);
+
+    int level(_levels.size());
+
+    _levels.emplace_back(size.x * size.y);
+    _level_sizes.push_back(size);
+
+    for (int r{0}; r < size.y; r++) {
+      for (int c{0}; c < size.x; c++)
+        _levels[level][r * size.x + c] = merge(level, c, r);
+    }
+  }
+}
+
+// updates the blocks above a changed cell, stopping once one is unchanged
+void MapRenderer::propagate(int c, int r) {
+  for (int level{1}; level < (int)_levels.size(); level++) {
+    c /= 2;
+    r /= 2;
+
+    std::uint8_t& cell{_levels[level][r * _level_sizes[level].x + c]};
+    std::uint8_t tile{merge(level, c, r)};
+
+    if (cell == tile)
+      return;
+
+    cell = tile;
+  }
+}
+
+// marks the screen chunks showing the level of detail block holding (c, r)
+void MapRenderer::mark_cell(int c, int r) {
+  const int block{1 << _level};
+  float left{(float)(c >> _level << _level)};
+  float top{(float)(r >> _level << _level)};
+
+  int x0{std::max(0, (int)std::floor((left - _origin.x) * _zoom - 0.5f))};
+  int y0{std::max(0, (int)std::floor((top - _origin.y) * _zoom - 0.5f))};
+  int x1{std::min(_screen.x, (int)std::ceil((left + block - _origin.x) * _zoom))};
+  int y1{std::min(_screen.y, (int)std::ceil((top + block - _origin.y) * _zoom))};
+
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  for (int cy{y0 / chunk_px}; cy <= (y1 - 1) / chunk_px; cy++) {
+    for (int cx{x0 / chunk_px}; cx <= (x1 - 1) / chunk_px; cx++)
+      _dirty_chunks[cy * _chunks.x + cx] = 1;
+  }
+
+  _any_dirty = true;
+}
+
+void MapRenderer::sync(TileMap& tile_map) {
+  if (tile_map.all_modified() || _levels.empty() ||
+    _level_sizes[0] != sf::Vector2i(tile_map.width(), tile_map.height()))
+  {
+    rebuild(tile_map);
+    _drawn = false;
+  }
+
+  else {
+    for (const auto& tile : tile_map.modified_tiles()) {
+      int r{tile.first};
+      int c{tile.second};
+
+      _levels[0][r * tile_map.width() + c] = tile_map.get_tile(c, r);
+      propagate(c, r);
+
+      if (_drawn)
+        mark_cell(c, r);
+    }
+  }
+
+  tile_map.reset_modified_tiles();
+}
+
+bool MapRenderer::dirty(const Camera& camera) const {
+  return !_drawn || _any_dirty || camera.zoom() != _zoom ||
+    camera.to_world(sf::Vector2f(0, 0)) != _origin;
+}
+
+// each screen pixel covers at most one cell of the chosen level
+void MapRenderer::set_view(const Camera& camera) {
+  const int tile_px{_raster.tile_px()};
+  const sf::Vector2i world{_level_sizes[0]};
+
+  _zoom = camera.zoom();
+  _origin = camera.to_world(sf::Vector2f(0, 0));
+  _level = 0;
+
+  if (_zoom < 1) {
+    _level = std::min((int)_levels.size() - 1,
+      (int)std::ceil(std::log2(1 / _zoom)));
+  }
+
+  for (int x{0}; x < _screen.x; x++) {
+    float wx{_origin.x + (x + 0.5f) / _zoom};
+
+    if (wx < 0 || wx >= world.x) {
+      _col_cells[x] = -1;
+
+      continue;
+    }
+
+    _col_cells[x] = (int)wx >> _level;
+    _col_px[x] = (int)((wx - std::floor(wx)) * tile_px);
+  }
+}
+
+// rasterises the screen pixels [x0, x1) x [y0, y1)
+void MapRenderer::draw_rect(int x0, int y0, int x1, int y1) {
+  const sf::Vector2i world{_level_sizes[0]};
+  const int tile_px{_raster.tile_px()};
+  const auto& cells{_levels[_level]};
+  const int level_width{_level_sizes[_level].x};
+  const bool sampled{_level == 0 && _zoom >= 1};
+  const int span_bytes{(x1 - x0) * TileRaster::channels};
+
+  for (int y{y0}; y < y1; y++) {
+    std::uint8_t* out{&_pixels[(y * _screen.x + x0) * TileRaster::channels]};
+    float wy{_origin.y + (y + 0.5f) / _zoom};
+
+    if (wy < 0 || wy >= world.y) {
+      std::memset(out, 0, span_bytes);
+
+      continue;
+    }
+
+    const std::uint8_t* row{&cells[((int)wy >> _level) * level_width]};
+    const int py{(int)((wy - std::floor(wy)) * tile_px)};
+
+    for (int x{x0}; x < x1; x++, out += TileRaster::channels) {
+      if (_col_cells[x] < 0) {
+        std::memset(out, 0, TileRaster::channels);
+
+        continue;
+      }
+
+      int tile{row[_col_cells[x]]};
+
+      const std::uint8_t* src{sampled ?
+        _raster.tile(tile) + (py * tile_px + _col_px[x]) * TileRaster::channels :
+        _raster.colour(tile)};
+
+      std::memcpy(out, src, TileRaster::channels);
+    }
+  }
+}
+
+// Texture::update wants tightly packed pixels so the span is copied out
+// of the screen buffer first
+void MapRenderer::upload_rect(int x0, int y0, int x1, int y1) {
+  const int span_bytes{(x1 - x0) * TileRaster::channels};
+
+  for (int y{y0}; y < y1; y++) {
+    std::memcpy(&_upload[(y - y0) * span_bytes],
+      &_pixels[(y * _screen.x + x0) * TileRaster::channels], span_bytes);
+  }
+
+  _texture.update(_upload.data(), x1 - x0, y1 - y0, x0, y0);
+}
+
+void MapRenderer::render(const Camera& camera) {
+  if (_levels.empty() || !dirty(camera))
+    return;
+
+  if (!_drawn || camera.zoom() != _zoom ||
+    camera.to_world(sf::Vector2f(0, 0)) != _origin)
+  {
+    set_view(camera);
+    draw_rect(0, 0, _screen.x, _screen.y);
+    _texture.update(_pixels.data());
+    _drawn = true;
+  }
+
+  // runs of dirty chunks along each row of chunks go up as one rectangle
+  else {
+    for (int cy{0}; cy < _chunks.y; cy++) {
+      int y0{cy * chunk_px};
+      int y1{std::min(y0 + chunk_px, _screen.y)};
+
+      for (int cx{0}; cx < _chunks.x; cx++) {
+        if (!_dirty_chunks[cy * _chunks.x + cx])
+          continue;
+
+        int end{cx};
+
+        while (end < _chunks.x && _dirty_chunks[cy * _chunks.x + end])
+          end++;
+
+        int x0{cx * chunk_px};
+        int x1{std::min(end * chunk_px, _screen.x)};
+
+        draw_rect(x0, y0, x1, y1);
+        upload_rect(x0, y0, x1, y1);
+        cx = end;
+      }
+    }
+  }
+
+  std::fill(_dirty_chunks.begin(), _dirty_chunks.end(), 0);
+  _any_dirty = false;
+}
\ No newline at end of file
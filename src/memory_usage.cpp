@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+
+#include "memory_usage.hpp"
+
+namespace memory_usage {
+  // the second field of statm is the resident page count
+  std::size_t resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages{};
+    std::size_t resident{};
+
+    if (!(statm >> pages >> resident))
+      return 0;
+
+    return resident * sysconf(_SC_PAGESIZE);
+  }
+}
+
+static void print_bytes(std::ostream& out, std::size_t bytes) {
+  out << std::fixed << std::setprecision(1) << std::setw(10) <<
+    bytes / 1024.0 << " KiB";
+}
+
+const std::vector<MemoryReport::Entry>& MemoryReport::entries() const {
+  return _entries;
+}
+
+std::size_t MemoryReport::total() const {
+  std::size_t total{0};
+
+  for (const auto& entry : _entries)
+    total += entry.bytes;
+
+  return total;
+}
+
+void MemoryReport::add(std::string_view name, std::size_t bytes) {
+  _entries.push_back({name, bytes});
+}
+
+void MemoryReport::clear() { _entries.clear(); }
+
+void MemoryReport::print(std::ostream& out) const {
+  std::ios_base::fmtflags flags{out.flags()};
+  std::streamsize precision{out.precision()};
+
+  for (const auto& entry : _entries) {
+    out << "  " << std::left << std::setw(16) << entry.name << std::right;
+    print_bytes(out, entry.bytes);
+    out << "\n";
+  }
+
+  out << "  " << std::left << std::setw(16) << "total" << std::right;
+  print_bytes(out, total());
+  out << "\n";
+
+  if (std::size_t resident{memory_usage::resident_bytes()}) {
+    out << "  " << std::left << std::setw(16) << "process resident" <<
+      std::right;
+
+    print_bytes(out, resident);
+    out << "\n";
+  }
+
+  out.flags(flags);
+  out.precision(precision);
+}
+
+MemoryBudget::MemoryBudget(std::size_t max_bytes, MemoryPolicy policy) :
+  _max_bytes(max_bytes), _policy(policy) {}
+
+bool MemoryBudget::enabled() const { return _max_bytes > 0; }
+MemoryPolicy MemoryBudget::policy() const { return _policy; }
+
+bool MemoryBudget::over(std::size_t total) const {
+  return enabled() && total > _max_bytes;
+}
\ No newline at end of file
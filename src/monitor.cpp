@@ -0,0 +1,76 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include "telemetry.hpp"
+
+static const std::chrono::milliseconds poll_interval{100};
+
+static void print_header() {
+  std::cout << std::setw(8) << "turn" << std::setw(10) << "bunnies" <<
+    std::setw(10) << "infected" << std::setw(8) << "births" <<
+    std::setw(8) << "deaths" << std::setw(8) << "culls" <<
+    std::setw(10) << "update us" << std::setw(10) << "births us" <<
+    std::setw(10) << "sort us" << "\n";
+}
+
+static void print_record(const TelemetryRecord& record) {
+  std::cout << std::setw(8) << record.turn << std::setw(10) <<
+    record.population << std::setw(10) << record.infected << std::setw(8) <<
+    record.births << std::setw(8) << record.deaths << std::setw(8) <<
+    record.culls << std::setw(10) << record.timings.update / 1000 <<
+    std::setw(10) << record.timings.births / 1000 << std::setw(10) <<
+    record.timings.sort / 1000 << "\n";
+}
+
+// Follows a simulation's telemetry ring, printing each turn as it is
+// published. Waits for the ring to appear and follows the next run once
+// the simulation exits.
+int main(int argc, char *argv[]) {
+  std::string name(argc > 1 ? argv[1] : telemetry::default_name);
+
+  while (true) {
+    TelemetryReader reader(name);
+
+    if (!reader.attached()) {
+      std::this_thread::sleep_for(poll_interval);
+
+      continue;
+    }
+
+    print_header();
+
+    std::uint64_t next{0};
+    bool closed{false};
+
+    while (!closed) {
+      // checked before reading so the last records are not missed
+      closed = reader.closed();
+
+      std::uint64_t written{reader.written()};
+
+      if (written - next > reader.capacity()) {
+        std::cout << "(skipped " << written - reader.capacity() - next <<
+          " turns)\n";
+
+        next = written - reader.capacity();
+      }
+
+      TelemetryRecord record{};
+
+      for (; next < written; next++) {
+        if (reader.read(next, record))
+          print_record(record);
+      }
+
+      std::cout.flush();
+
+      if (!closed)
+        std::this_thread::sleep_for(poll_interval);
+    }
+
+    std::cout << "Simulation exited\n";
+  }
+}
\ No newline at end of file
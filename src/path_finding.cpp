@@ -1,77 +1,53 @@
-#include <queue>
-#include <set>
+#include <algorithm>
 
 #include "path_finding.hpp"
+#include "memory_usage.hpp"
 
 namespace path_finding {
-  std::pair<int, int> traverse(std::pair<int, int> start, Dir dir) {
-    std::pair<int, int> end(start);
-
-    switch (dir) {
-      case Dir::left:
-        end.first -= 1;
-
-        break;
-
-      case Dir::right:
-        end.first += 1;
-
-        break;
-
-      case Dir::up:
-        end.second -= 1;
-
-        break;
-
-      case Dir::down:
-        end.second += 1;
+  void Scratch::prepare(int cells) {
+    if ((int)stamp.size() != cells) {
+      stamp.assign(cells, 0);
+      parent.resize(cells);
+      cost.resize(cells);
+      generation = 0;
+    }
 
-        break;
+    // on wrap around old stamps could alias the new generation
+    if (++generation == 0) {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      generation = 1;
     }
 
-    return end;
+    queue.clear();
+    heap.clear();
   }
 
-  // std::pair<int, int> traverse(std::pair<int, int> start,
-  //   std::string_view path)
-  // {
-  //   std::pair<int, int> end(start);
-
-  //   for (const auto& ch : path)
-  //     end = traverse(end, ch);
+  Scratch& thread_scratch() {
+    thread_local Scratch scratch{};
 
-  //   return end;
-  // }
-
-  // std::pair<bool, std::string> bfs(std::pair<int, int> start,
-  //   std::pair<int, int> goal, std::function<bool(int, int)> valid_move)
-  // {
-  //   std::queue<std::string> paths{};
-
-  //   paths.push("");
-
-  //   std::string path{""};
-  //   std::set<std::pair<int, int>> visited{};
-
-  //   while (traverse(start, path) != goal) {
-  //     if (paths.empty())
-  //       return {false, path};
+    return scratch;
+  }
 
-  //     path = paths.front();
-  //     paths.pop();
+  void build_path(const Scratch& scratch, int goal, std::vector<int>& path) {
+    path.clear();
 
-  //     for (const auto ch : "LRUD") {
-  //       std::string put{path + ch};
-  //       std::pair<int, int> end{traverse(start, put)};
+    for (int cell{goal}; cell != no_cell; cell = scratch.parent[cell])
+      path.push_back(cell);
 
-  //       if (!visited.contains(end) && valid_move(end.first, end.second)) {
-  //         visited.insert(end);
+    std::reverse(path.begin(), path.end());
+  }
 
-  //         paths.push(put);
-  //       }
-  //     }
-  //   }
+  std::size_t DistanceField::memory_bytes() const {
+    return memory_usage::bytes(_stamp) + memory_usage::bytes(_dist) +
+      memory_usage::bytes(_queue);
+  }
 
-  //   return {true, path};
-  // }
+  void DistanceField::resize(int width, int height) {
+    _width = width;
+    _height = height;
+    _stamp.assign(width * height, 0);
+    _dist.resize(width * height);
+    _queue.reserve(width * height);
+    _generation = 1; // nothing reachable until the first build
+  }
 }
\ No newline at end of file
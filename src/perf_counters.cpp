@@ -0,0 +1,81 @@
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+static int open_counter(std::uint32_t type, std::uint64_t config) {
+  perf_event_attr attr{};
+
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+#ifdef __linux__
+  _fds[cache_misses] = open_counter(PERF_TYPE_HARDWARE,
+    PERF_COUNT_HW_CACHE_MISSES);
+
+  _fds[dtlb_misses] = open_counter(PERF_TYPE_HW_CACHE,
+    PERF_COUNT_HW_CACHE_DTLB | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+    PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  _fds[page_faults] = open_counter(PERF_TYPE_SOFTWARE,
+    PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+  for (const auto fd : _fds) {
+    if (fd >= 0)
+      close(fd);
+  }
+}
+
+bool PerfCounters::available(Counter counter) const {
+  return _fds[counter] >= 0;
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+  for (const auto fd : _fds) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+  for (const auto fd : _fds) {
+    if (fd >= 0)
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+#endif
+}
+
+std::uint64_t PerfCounters::read(Counter counter) const {
+  std::uint64_t value{0};
+
+  if (_fds[counter] < 0 ||
+    ::read(_fds[counter], &value, sizeof(value)) != sizeof(value))
+  {
+    return 0;
+  }
+
+  return value;
+}
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <array>
+
+#include "reference_manager.hpp"
+#include "rules.hpp"
+#include "path_finding.hpp"
+
+using path_finding::Dir;
+using Rules = rules::Classic;
+
+static const std::unordered_map<TileType, TileType> bunny_mutant_map {
+  {TileType::white_juvenile, TileType::white_juvenile_mutant},
+  {TileType::white_adult, TileType::white_adult_mutant},
+  {TileType::brown_juvenile, TileType::brown_juvenile_mutant},
+  {TileType::brown_adult, TileType::brown_adult_mutant},
+  {TileType::black_juvenile, TileType::black_juvenile_mutant},
+  {TileType::black_adult, TileType::black_adult_mutant},
+  {TileType::spotted_juvenile, TileType::spotted_juvenile_mutant},
+  {TileType::spotted_adult, TileType::spotted_adult_mutant},
+};
+
+static const std::unordered_map<BunnyColour, std::pair<TileType, TileType>> bunny_colour_map {
+  {BunnyColour::white, {TileType::white_juvenile, TileType::white_adult}},
+  {BunnyColour::brown, {TileType::brown_juvenile, TileType::brown_adult}},
+  {BunnyColour::black, {TileType::black_juvenile, TileType::black_adult}},
+  {BunnyColour::spotted, {TileType::spotted_juvenile, TileType::spotted_adult}}
+};
+
+static std::array<Dir, 4> rnd_dirs() {
+  std::array<Dir, 4> dirs{Dir::left, Dir::right, Dir::up, Dir::down};
+  std::shuffle(dirs.begin(), dirs.end(), util::rng());
+
+  return dirs;
+}
+
+bool ReferenceManager::is_overaged(const Bunny& bunny) {
+  return ((bunny.infected() && bunny.age() >= util::rnd_range(
+    Rules::min_infected_lifespan, Rules::max_infected_lifespan)) ||
+    (!bunny.infected() && bunny.age() >= util::rnd_range(
+      Rules::min_lifespan, Rules::max_lifespan)));
+}
+
+void ReferenceManager::emit(EventType type, const Bunny& bunny,
+  sf::Vector2i from)
+{
+  TurnEvent event{};
+
+  event.type = type;
+  event.colour = (std::uint8_t)bunny.colour();
+  event.gender = (std::uint8_t)bunny.gender();
+  event.flags = (bunny.infected() ? TurnEvent::infected_flag : 0) |
+    (bunny.age() >= Rules::adult_age ? TurnEvent::adult_flag : 0);
+
+  if (type == EventType::moved || type == EventType::died ||
+    type == EventType::culled || type == EventType::removed)
+  {
+    event.floor = (std::uint8_t)_floor_tile;
+  }
+
+  event.age = bunny.age();
+  event.name = bunny.name_index();
+  event.id = bunny.id();
+  event.pos = bunny.pos;
+  event.from = from;
+
+  _events.events.push_back(event);
+}
+
+void ReferenceManager::publish() {
+  for (auto consumer : _consumers)
+    consumer->consume(_events);
+}
+
+bool ReferenceManager::walkable(sf::Vector2i pos) const {
+  return _tile_map.in_bounds(pos.x, pos.y) &&
+    (!_walk_map || _walk_map->walkable(pos.x, pos.y));
+}
+
+void ReferenceManager::spawn_initial(int amount) {
+  if (_walk_map) {
+    int largest{_walk_map->largest_component()};
+
+    amount = largest == WalkMap::no_component ? 0 :
+      std::min(amount, _walk_map->component_size(largest));
+  }
+
+  for (int i{0}; i < amount; i++) {
+    sf::Vector2i pos{};
+
+    do {
+      pos.x = util::rnd_range(0, _tile_map.width() - 1);
+      pos.y = util::rnd_range(0, _tile_map.height() - 1);
+    } while (_bunny_pos_map.contains(pos) || (_walk_map &&
+      _walk_map->component(pos.x, pos.y) != _walk_map->largest_component()));
+
+    add_bunny(Bunny(pos, Rules::max_initial_age, Rules::mutant_chance),
+      Bunny::no_id);
+  }
+}
+
+Bunny& ReferenceManager::add_bunny(const Bunny& bunny, std::uint32_t mother) {
+  auto it{_bunnies.insert(_bunnies.end(), bunny)};
+
+  it->set_id(_next_id++);
+  _bunny_pos_map.insert({it->pos, &*it});
+
+  set_bunny_tile(*it);
+  emit(EventType::born, *it);
+  _events.events.back().mother = mother;
+
+  return *it;
+}
+
+void ReferenceManager::set_bunny_tile(const Bunny& bunny) {
+  auto tile_types{bunny_colour_map.at(bunny.colour())};
+  TileType tile_type{
+    bunny.age() < Rules::adult_age ? tile_types.first : tile_types.second
+  };
+  
+  if (bunny.infected())
+    tile_type = bunny_mutant_map.at(tile_type);
+  
+  _tile_map.set_tile(bunny.pos.x, bunny.pos.y, (int)tile_type);
+}
+
+void ReferenceManager::move_bunny_adj(Bunny& bunny) {
+  for (const auto dir : rnd_dirs()) {
+    sf::Vector2i new_pos{path_finding::traverse(bunny.pos, dir)};
+
+    if (!walkable(new_pos))
+      continue;
+
+    if (!_bunny_pos_map.contains(new_pos)) {
+      sf::Vector2i from{bunny.pos};
+
+      _tile_map.set_tile(bunny.pos.x, bunny.pos.y, (int)_floor_tile);
+      _bunny_pos_map.erase(bunny.pos);
+
+      bunny.pos = new_pos;
+
+      _bunny_pos_map.insert({bunny.pos, &bunny});
+      set_bunny_tile(bunny);
+      emit(EventType::moved, bunny, from);
+      
+      break;
+    }
+  }
+}
+
+void ReferenceManager::mutate_adj(sf::Vector2i pos) {
+  for (const auto dir : rnd_dirs()) {
+    sf::Vector2i adj_pos{path_finding::traverse(pos, dir)};
+
+    if (_bunny_pos_map.contains(adj_pos)) {
+      Bunny& bunny{*_bunny_pos_map.at(adj_pos)};
+
+      if (bunny.infected())
+        continue;
+
+      bunny.infect();
+      set_bunny_tile(bunny);
+      emit(EventType::infected, bunny);
+
+      break;
+    }
+  }
+}
+
+void ReferenceManager::birth_bunnies(std::list<Bunny*>& breedable_females) {
+  for (const auto female : breedable_females) {
+    sf::Vector2i pos{female->pos};
+
+    for (const auto dir : rnd_dirs()) {
+      sf::Vector2i new_pos{path_finding::traverse(pos, dir)};
+
+      if (!walkable(new_pos))
+        continue;
+
+      if (!_bunny_pos_map.contains(new_pos)) {
+        Bunny& bunny{add_bunny(
+          Bunny(new_pos, 0, female->colour(), Rules::mutant_chance),
+          female->id()
+        )};
+
+        if (bunny.infected())
+          mutate_adj(bunny.pos);
+
+        break;
+      }
+    }
+  }
+}
+
+void ReferenceManager::sort_by_age() {
+  _bunnies.sort(
+    [](const Bunny& b1, const Bunny& b2) {
+      return b1.age() < b2.age();
+    }
+  );
+}
+
+void ReferenceManager::food_shortage() {
+  _events.events.push_back({EventType::shortage});
+  _cull_bunnies.resize(_bunnies.size());
+  
+  std::fill(
+    _cull_bunnies.begin(),
+    _cull_bunnies.begin() + (Rules::bunny_limit / 2), 
+    false
+  );
+
+  std::fill(
+    _cull_bunnies.begin() + (Rules::bunny_limit / 2),
+    _cull_bunnies.end(), 
+    true
+  );
+
+  std::shuffle(_cull_bunnies.begin(), _cull_bunnies.end(), util::rng());
+  
+  int i{0};
+
+  // cull half at random
+  for (auto it{_bunnies.begin()}; it != _bunnies.end(); i++) {
+    if (_cull_bunnies.at(i)) {
+      _tile_map.set_tile(it->pos.x, it->pos.y, (int)_floor_tile);
+      emit(EventType::culled, *it);
+      _bunny_pos_map.erase(it->pos);
+
+      it = _bunnies.erase(it);
+    }
+
+    else
+      it++;
+  }
+}
+
+ReferenceManager::ReferenceManager(TileMap& tile_map, TileType floor_tile,
+  std::vector<EventConsumer*> consumers, const WalkMap* walk_map) :
+    _tile_map(tile_map),
+    _floor_tile(floor_tile),
+    _walk_map(walk_map),
+    _consumers(std::move(consumers)),
+    _cull_bunnies(Rules::bunny_limit)
+{
+  for (const auto consumer : _consumers)
+    _roster = _roster || consumer->wants_roster();
+
+  _events.clear(0);
+  spawn_initial(Rules::initial_spawn);
+  publish();
+}
+
+int ReferenceManager::turn() const { return _turn; }
+int ReferenceManager::population() const { return _bunnies.size(); }
+
+bool ReferenceManager::next_turn() {
+  if (_bunnies.empty())
+    return true;
+
+  _events.clear(++_turn);
+
+  int breedable_male_count{0};
+  std::list<Bunny*> breedable_females{};
+
+  for(auto it{_bunnies.begin()}; it != _bunnies.end();) {
+    Bunny& bunny{*it};
+
+    // kill over-aged bunnies
+    if (is_overaged(bunny)) {
+      _tile_map.set_tile(bunny.pos.x, bunny.pos.y, (int)_floor_tile);
+      emit(EventType::died, bunny);
+      _bunny_pos_map.erase(it->pos);
+      it = _bunnies.erase(it);
+
+      continue;
+    }
+    
+    move_bunny_adj(bunny);
+
+    if (bunny.infected())
+      mutate_adj(bunny.pos);
+
+    bunny.grow(1);
+
+    // grown bunnies keep their tile until they next move or are infected
+    if (!bunny.infected() && bunny.age() >= Rules::adult_age) {
+      if (bunny.gender() == Gender::male)
+        breedable_male_count += 1;
+      
+      else
+        breedable_females.push_back(&bunny);
+    }
+
+    ++it;
+  }
+
+  if (breedable_male_count)
+    birth_bunnies(breedable_females);
+
+  sort_by_age();
+
+  if (_roster) {
+    _events.events.push_back({EventType::roster_begin});
+
+    for (const auto& bunny : _bunnies)
+      emit(EventType::remaining, bunny);
+
+    _events.events.push_back({EventType::roster_end});
+  }
+
+  if ((int)_bunnies.size() > Rules::bunny_limit)
+    food_shortage();
+
+  publish();
+
+  return false;
+}
+
+void ReferenceManager::reset() {
+  _turn = 0;
+  _events.clear(0);
+
+  for (const auto& bunny : _bunnies) {
+    _tile_map.set_tile(bunny.pos.x, bunny.pos.y, (int)_floor_tile);
+    emit(EventType::removed, bunny);
+  }
+
+  _bunnies.clear();
+  _bunny_pos_map.clear();
+  spawn_initial(Rules::initial_spawn);
+  publish();
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "room_generator.hpp"
+
+static const int room_min_size{5};
+static const int room_gap{1}; // wall tiles kept between rooms
+
+bool y_intersects(room_t room1, room_t room2) {
+  return room1.left < room2.left + room2.width &&
+    room1.left + room1.width > room2.left;
+}
+
+bool x_intersects(room_t room1, room_t room2) {
+  return room1.top < room2.top + room2.height &&
+    room1.top + room1.height > room2.top;
+}
+
+const std::vector<room_t>& RoomGenerator::rooms() const { return _rooms; }
+
+const std::vector<std::pair<room_t, CorridorType>>&
+  RoomGenerator::corridors() const
+{
+  return _corridors;
+}
+
+RoomGenerator::RoomGenerator(int tile_map_width, int tile_map_height) :
+  _tile_map_width(tile_map_width), _tile_map_height(tile_map_height) {}
+
+room_t RoomGenerator::create_room(int min_size) const {
+  room_t new_room{};
+  new_room.width = util::rnd_range(min_size,
+    std::max(min_size, _tile_map_width / 3));
+  new_room.height = util::rnd_range(min_size,
+    std::max(min_size, _tile_map_height / 3));
+  new_room.left = util::rnd_range(0, _tile_map_width - new_room.width);
+  new_room.top = util::rnd_range(0, _tile_map_height - new_room.height);
+
+  return new_room;
+}
+
+bool RoomGenerator::overlaps(room_t room) const {
+  room_t padded(room.left - room_gap, room.top - room_gap,
+    room.width + room_gap * 2, room.height + room_gap * 2);
+
+  for (const auto& other : _rooms) {
+    if (y_intersects(padded, other) && x_intersects(padded, other))
+      return true;
+  }
+
+  return false;
+}
+
+// L shaped corridor between room centres, horizontal leg first
+void RoomGenerator::connect(room_t room1, room_t room2) {
+  sf::Vector2i from(room1.left + room1.width / 2,
+    room1.top + room1.height / 2);
+
+  sf::Vector2i to(room2.left + room2.width / 2, room2.top + room2.height / 2);
+
+  _corridors.push_back({
+    room_t(std::min(from.x, to.x), from.y, std::abs(to.x - from.x) + 1, 1),
+    CorridorType::horizontal
+  });
+
+  _corridors.push_back({
+    room_t(to.x, std::min(from.y, to.y), 1, std::abs(to.y - from.y) + 1),
+    CorridorType::vertical
+  });
+}
+
+void RoomGenerator::gen() {
+  const int iterations{(_tile_map_width + _tile_map_height) * 2};
+
+  _rooms.clear();
+  _corridors.clear();
+
+  if (_tile_map_width < room_min_size || _tile_map_height < room_min_size)
+    return;
+
+  for (int i = 0; i < iterations; i++) {
+    room_t new_room = create_room(room_min_size);
+
+    if (overlaps(new_room))
+      continue;
+
+    if (!_rooms.empty())
+      connect(_rooms.back(), new_room);
+
+    _rooms.push_back(new_room);
+  }
+}
+
+void RoomGenerator::carve(TileMap& tile_map, int floor_tile,
+  int wall_tile) const
+{
+  tile_map.clear(wall_tile);
+
+  for (const auto& room : _rooms)
+    tile_map.fill_rect(room, floor_tile);
+
+  for (const auto& corridor : _corridors)
+    tile_map.fill_rect(corridor.first, floor_tile);
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+#include "shared_memory.hpp"
+
+SharedMemory::SharedMemory(std::size_t size) {
+  void* data{mmap(nullptr, size, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_ANONYMOUS, -1, 0)};
+
+  if (data == MAP_FAILED)
+    return;
+
+  _data = data;
+  _size = size;
+}
+
+// any segment left behind by a process that crashed is truncated away
+SharedMemory SharedMemory::create(std::string_view name, std::size_t size) {
+  SharedMemory memory{};
+  std::string path(name);
+  int fd{shm_open(path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644)};
+
+  if (fd < 0)
+    return memory;
+
+  void* data{MAP_FAILED};
+
+  if (ftruncate(fd, size) == 0)
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    shm_unlink(path.c_str());
+
+    return memory;
+  }
+
+  memory._data = data;
+  memory._size = size;
+  memory._name = path;
+
+  return memory;
+}
+
+SharedMemory SharedMemory::open(std::string_view name) {
+  SharedMemory memory{};
+  std::string path(name);
+  int fd{shm_open(path.c_str(), O_RDONLY, 0)};
+
+  if (fd < 0)
+    return memory;
+
+  struct stat info{};
+  void* data{MAP_FAILED};
+
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+    data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+  close(fd);
+
+  if (data == MAP_FAILED)
+    return memory;
+
+  memory._data = data;
+  memory._size = info.st_size;
+
+  return memory;
+}
+
+SharedMemory::~SharedMemory() {
+  if (_data)
+    munmap(_data, _size);
+
+  if (!_name.empty())
+    shm_unlink(_name.c_str());
+}
+
+SharedMemory::SharedMemory(SharedMemory&& other) noexcept :
+  _data(std::exchange(other._data, nullptr)),
+  _size(std::exchange(other._size, 0)),
+  _name(std::move(other._name))
+{
+  other._name.clear();
+}
+
+SharedMemory& SharedMemory::operator=(SharedMemory&& other) noexcept {
+  std::swap(_data, other._data);
+  std::swap(_size, other._size);
+  std::swap(_name, other._name);
+
+  return *this;
+}
+
+bool SharedMemory::valid() const { return _data; }
+void* SharedMemory::data() const { return _data; }
+std::size_t SharedMemory::size() const { return _size; }
\ No newline at end of file
@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "strip_worker.hpp"
+#include "rules.hpp"
+#include "path_finding.hpp"
+#include "rule_draws.hpp"
+
+using namespace domain;
+using Rules = rules::Classic;
+using rules::rnd_dirs;
+
+StripWorker::StripWorker(int width, int row_begin, int row_end,
+  Channel& coordinator, Channel* above, Channel* below) :
+    _width(width),
+    _row_begin(row_begin),
+    _row_end(row_end),
+    _coordinator(coordinator),
+    _neighbours{above, below}
+{
+  // allocated here, in the worker, so the pages are local to its node
+  _cells.resize(_width * (_row_end - _row_begin));
+  _age_counts.reserve(Rules::max_lifespan + 2);
+}
+
+bool StripWorker::owns(int row) const {
+  return row >= _row_begin && row < _row_end;
+}
+
+int StripWorker::cell_index(sf::Vector2i pos) const {
+  return (pos.y - _row_begin) * _width + pos.x;
+}
+
+bool StripWorker::occupied(sf::Vector2i pos) const {
+  return _cells[cell_index(pos)].valid();
+}
+
+// nullptr unless pos is in the row just past an edge shared with a strip
+HaloCell* StripWorker::halo_cell(sf::Vector2i pos) {
+  if (pos.y == _row_begin - 1 && _neighbours[above])
+    return &_halos[above][pos.x];
+
+  if (pos.y == _row_end && _neighbours[below])
+    return &_halos[below][pos.x];
+
+  return nullptr;
+}
+
+BunnyHandle StripWorker::add_bunny(const Bunny& bunny) {
+  BunnyHandle handle{_bunnies.create(bunny)};
+
+  _cells[cell_index(bunny.pos)] = handle;
+  _order.push_back(handle);
+
+  return handle;
+}
+
+// callers drop the handle from the order themselves
+void StripWorker::remove_bunny(BunnyHandle handle) {
+  _cells[cell_index(_bunnies[handle].pos)] = BunnyHandle();
+  _bunnies.destroy(handle);
+}
+
+void StripWorker::spawn(int amount) {
+  for (const auto handle : _order)
+    _cells[cell_index(_bunnies[handle].pos)] = BunnyHandle();
+
+  _bunnies.clear();
+  _order.clear();
+
+  amount = std::min(amount, (int)_cells.size());
+
+  for (int i{0}; i < amount; i++) {
+    sf::Vector2i pos{};
+
+    do {
+      pos.x = util::rnd_range(0, _width - 1);
+      pos.y = util::rnd_range(_row_begin, _row_end - 1);
+    } while (occupied(pos));
+
+    add_bunny(Bunny(pos, Rules::max_initial_age, Rules::mutant_chance));
+  }
+}
+
+void StripWorker::move_bunny_adj(BunnyHandle handle) {
+  Bunny& bunny{_bunnies[handle]};
+
+  for (const auto dir : rnd_dirs()) {
+    sf::Vector2i new_pos{path_finding::traverse(bunny.pos, dir)};
+
+    if (new_pos.x < 0 || new_pos.x >= _width)
+      continue;
+
+    if (owns(new_pos.y)) {
+      if (occupied(new_pos))
+        continue;
+
+      _cells[cell_index(bunny.pos)] = BunnyHandle();
+      bunny.pos = new_pos;
+      _cells[cell_index(bunny.pos)] = handle;
+      _stats.moves++;
+
+      break;
+    }
+
+    // the bunny keeps its cell until the neighbour takes it
+    HaloCell* halo{halo_cell(new_pos)};
+
+    if (halo && *halo == HaloCell::empty) {
+      Side side{new_pos.y < _row_begin ? above : below};
+
+      *halo = HaloCell::reserved;
+      _migrants[side].push_back(handle);
+      _migrant_targets[side].push_back(new_pos);
+
+      break;
+    }
+  }
+}
+
+void StripWorker::mutate_adj(sf::Vector2i pos) {
+  for (const auto dir : rnd_dirs()) {
+    sf::Vector2i adj_pos{path_finding::traverse(pos, dir)};
+
+    if (adj_pos.x < 0 || adj_pos.x >= _width)
+      continue;
+
+    if (owns(adj_pos.y)) {
+      if (!occupied(adj_pos))
+        continue;
+
+      Bunny& bunny{_bunnies[_cells[cell_index(adj_pos)]]};
+
+      if (bunny.infected())
+        continue;
+
+      bunny.infect();
+      _stats.infections++;
+
+      break;
+    }
+
+    HaloCell* halo{halo_cell(adj_pos)};
+
+    if (halo && *halo == HaloCell::healthy) {
+      *halo = HaloCell::infected;
+      _infections[adj_pos.y < _row_begin ? above : below].push_back(adj_pos);
+
+      break;
+    }
+  }
+}
+
+// newborns stay inside the strip
+void StripWorker::birth_bunnies() {
+  for (const auto female : _breedable_females) {
+    // copied as creating a bunny may move the pool's records
+    sf::Vector2i pos{_bunnies[female].pos};
+    BunnyColour colour{_bunnies[female].colour()};
+
+    for (const auto dir : rnd_dirs()) {
+      sf::Vector2i new_pos{path_finding::traverse(pos, dir)};
+
+      if (new_pos.x < 0 || new_pos.x >= _width || !owns(new_pos.y) ||
+        occupied(new_pos))
+      {
+        continue;
+      }
+
+      BunnyHandle handle{
+        add_bunny(Bunny(new_pos, 0, colour, Rules::mutant_chance))
+      };
+
+      _stats.births++;
+
+      if (_bunnies[handle].infected())
+        mutate_adj(new_pos);
+
+      break;
+    }
+  }
+}
+
+// stable counting sort, as in BasicBunnyManager
+void StripWorker::sort_by_age() {
+  int max_age{0};
+
+  for (const auto handle : _order)
+    max_age = std::max(max_age, _bunnies[handle].age());
+
+  _age_counts.assign(max_age + 2, 0);
+
+  for (const auto handle : _order)
+    _age_counts[_bunnies[handle].age() + 1]++;
+
+  for (int age{1}; age < (int)_age_counts.size(); age++)
+    _age_counts[age] += _age_counts[age - 1];
+
+  _order_scratch.resize(_order.size());
+
+  for (const auto handle : _order)
+    _order_scratch[_age_counts[_bunnies[handle].age()]++] = handle;
+
+  _order.swap(_order_scratch);
+}
+
+void StripWorker::cull(int amount) {
+  _cull_bunnies.assign(_order.size(), false);
+
+  std::fill(_cull_bunnies.begin(),
+    _cull_bunnies.begin() + std::min(amount, (int)_order.size()), true);
+
+  std::shuffle(_cull_bunnies.begin(), _cull_bunnies.end(), util::rng());
+
+  for (std::size_t i{0}; i < _order.size(); i++) {
+    if (_cull_bunnies[i])
+      remove_bunny(_order[i]);
+  }
+
+  compact_order();
+}
+
+void StripWorker::compact_order() {
+  std::size_t kept{0};
+
+  for (const auto handle : _order) {
+    if (_bunnies.alive(handle))
+      _order[kept++] = handle;
+  }
+
+  _order.resize(kept);
+}
+
+template<typename Send, typename Receive>
+void StripWorker::exchange(Send send, Receive receive) {
+  if (_neighbours[below])
+    send(below);
+
+  if (_neighbours[above]) {
+    receive(above);
+    send(above);
+  }
+
+  if (_neighbours[below])
+    receive(below);
+}
+
+// Migrants and infections go out with their counts. Each strip takes the
+// migrants whose cell is still free and replies with a byte per migrant;
+// the sender then drops the ones that were taken.
+void StripWorker::exchange_requests() {
+  exchange(
+    [this](Side side) {
+      Channel& channel{*_neighbours[side]};
+
+      _migrant_records.clear();
+
+      for (std::size_t i{0}; i < _migrants[side].size(); i++) {
+        Bunny bunny{_bunnies[_migrants[side][i]]};
+
+        bunny.pos = _migrant_targets[side][i];
+        _migrant_records.push_back(std::bit_cast<BunnyBytes>(bunny));
+      }
+
+      channel.send_value<std::uint32_t>(_migrant_records.size());
+      channel.send_value<std::uint32_t>(_infections[side].size());
+      channel.send_array(_migrant_records);
+      channel.send_array(_infections[side]);
+    },
+    [this](Side side) {
+      Channel& channel{*_neighbours[side]};
+      auto migrants{channel.receive_value<std::uint32_t>()};
+      auto infections{channel.receive_value<std::uint32_t>()};
+
+      channel.receive_array(_incoming, migrants);
+      channel.receive_array(_incoming_infections, infections);
+
+      for (const auto pos : _incoming_infections) {
+        if (!occupied(pos))
+          continue;
+
+        Bunny& bunny{_bunnies[_cells[cell_index(pos)]]};
+
+        if (!bunny.infected()) {
+          bunny.infect();
+          _stats.infections++;
+        }
+      }
+
+      _replies[side].assign(migrants, 0);
+
+      for (std::uint32_t i{0}; i < migrants; i++) {
+        Bunny bunny{std::bit_cast<Bunny>(_incoming[i])};
+
+        if (occupied(bunny.pos))
+          continue;
+
+        add_bunny(bunny);
+        _replies[side][i] = 1;
+        _stats.moves++;
+      }
+    }
+  );
+
+  exchange(
+    [this](Side side) { _neighbours[side]->send_array(_replies[side]); },
+    [this](Side side) {
+      _neighbours[side]->receive_array(_incoming_replies,
+        _migrants[side].size());
+
+      for (std::size_t i{0}; i < _migrants[side].size(); i++) {
+        if (_incoming_replies[i])
+          remove_bunny(_migrants[side][i]);
+      }
+    }
+  );
+
+  compact_order();
+}
+
+// the edge rows go to the neighbours as empty, healthy or infected cells
+void StripWorker::exchange_halos() {
+  exchange(
+    [this](Side side) {
+      const int row{side == above ? _row_begin : _row_end - 1};
+
+      _halo_out.resize(_width);
+
+      for (int c{0}; c < _width; c++) {
+        BunnyHandle handle{_cells[cell_index(sf::Vector2i(c, row))]};
+
+        _halo_out[c] = !handle.valid() ? HaloCell::empty :
+          _bunnies[handle].infected() ? HaloCell::infected :
+            HaloCell::healthy;
+      }
+
+      _neighbours[side]->send_array(_halo_out);
+    },
+    [this](Side side) {
+      _neighbours[side]->receive_array(_halos[side], _width);
+    }
+  );
+}
+
+void StripWorker::turn() {
+  _stats = TurnStats{};
+  _breedable_males = 0;
+  _breedable_females.clear();
+
+  for (const auto side : {above, below}) {
+    _migrants[side].clear();
+    _migrant_targets[side].clear();
+    _infections[side].clear();
+  }
+
+  std::size_t kept{0};
+
+  for (std::size_t i{0}; i < _order.size(); i++) {
+    BunnyHandle handle{_order[i]};
+    Bunny& bunny{_bunnies[handle]};
+
+    if (rules::is_overaged<Rules>(bunny)) {
+      remove_bunny(handle);
+      _stats.deaths++;
+
+      continue;
+    }
+
+    move_bunny_adj(handle);
+
+    if (bunny.infected())
+      mutate_adj(bunny.pos);
+
+    bunny.grow(1);
+
+    if (!bunny.infected() && bunny.age() >= Rules::adult_age) {
+      if (bunny.gender() == Gender::male)
+        _breedable_males++;
+
+      else
+        _breedable_females.push_back(handle);
+    }
+
+    _order[kept++] = handle;
+  }
+
+  _order.resize(kept);
+
+  // breeding waits for the whole world's male count
+  _coordinator.send_value(_breedable_males);
+
+  if (_coordinator.receive_value<Command>().value)
+    birth_bunnies();
+
+  exchange_requests();
+  sort_by_age();
+
+  _stats.population = _bunnies.size();
+  _coordinator.send_value(_stats);
+
+  cull(_coordinator.receive_value<Command>().value);
+  exchange_halos();
+}
+
+// returns on a stop or once any link has failed
+void StripWorker::run() {
+  while (true) {
+    Command command{_coordinator.receive_value<Command>()};
+
+    for (const auto channel : {&_coordinator, _neighbours[above],
+      _neighbours[below]})
+    {
+      if (channel && channel->failed())
+        return;
+    }
+
+    switch (command.type) {
+      case CommandType::spawn:
+        spawn(command.value);
+        exchange_halos();
+        _stats = TurnStats{};
+        _stats.population = _bunnies.size();
+        _coordinator.send_value(_stats);
+
+        break;
+
+      case CommandType::turn:
+        turn();
+
+        break;
+
+      case CommandType::stop:
+        return;
+
+      default:
+        break;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include <cstring>
+
+#include "telemetry.hpp"
+
+using namespace telemetry;
+
+TelemetryWriter::TelemetryWriter(std::string_view name,
+  std::uint32_t capacity)
+{
+  _memory = SharedMemory::create(name,
+    sizeof(Header) + sizeof(Slot) * capacity);
+
+  if (!_memory.valid())
+    return;
+
+  _header = static_cast<Header*>(_memory.data());
+  _slots = reinterpret_cast<Slot*>(_header + 1);
+  _header->capacity = capacity;
+  _header->record_size = sizeof(TelemetryRecord);
+
+  // readers only trust the layout once the magic number is in
+  _header->magic.store(magic, std::memory_order_release);
+}
+
+TelemetryWriter::~TelemetryWriter() {
+  if (_header)
+    _header->closed.store(1, std::memory_order_release);
+}
+
+bool TelemetryWriter::valid() const { return _header; }
+
+void TelemetryWriter::publish(const TelemetryRecord& record) {
+  if (!_header)
+    return;
+
+  Slot& slot{_slots[_next % _header->capacity]};
+
+  slot.sequence.store(_next * 2 + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(&slot.record, &record, sizeof(record));
+  slot.sequence.store(_next * 2 + 2, std::memory_order_release);
+
+  _header->written.store(++_next, std::memory_order_release);
+}
+
+TelemetryReader::TelemetryReader(std::string_view name) {
+  _memory = SharedMemory::open(name);
+
+  if (!_memory.valid() || _memory.size() < sizeof(Header))
+    return;
+
+  const auto* header{static_cast<const Header*>(_memory.data())};
+  if (header->magic.load(std::memory_order_acquire) != magic ||
+    header->record_size != sizeof(TelemetryRecord) ||
+    _memory.size() < sizeof(Header) + sizeof(Slot) * header->capacity)
+  {
+    return;
+  }
+
+  _header = header;
+  _slots = reinterpret_cast<const Slot*>(_header + 1);
+}
+
+bool TelemetryReader::attached() const { return _header; }
+std::uint32_t TelemetryReader::capacity() const { return _header->capacity; }
+
+std::uint64_t TelemetryReader::written() const {
+  return _header->written.load(std::memory_order_acquire);
+}
+
+bool TelemetryReader::closed() const {
+  return _header->closed.load(std::memory_order_acquire);
+}
+
+bool TelemetryReader::read(std::uint64_t index,
+  TelemetryRecord& record) const
+{
+  const Slot& slot{_slots[index % _header->capacity]};
+  std::uint64_t before{slot.sequence.load(std::memory_order_acquire)};
+
+  if (before != index * 2 + 2)
+    return false;
+
+  std::memcpy(&record, &slot.record, sizeof(record));
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  return slot.sequence.load(std::memory_order_relaxed) == before;
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include <algorithm>
+
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(int threads) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i{0}; i < threads; i++)
+    _workers.emplace_back(&ThreadPool::worker, this);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+
+  _work_cv.notify_all();
+
+  for (auto& worker : _workers)
+    worker.join();
+}
+
+int ThreadPool::size() const { return _workers.size(); }
+
+void ThreadPool::submit(std::function<void()> job) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _jobs.push_back(std::move(job));
+  }
+
+  _work_cv.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _done_cv.wait(lock, [this]() { return _jobs.empty() && _busy == 0; });
+}
+
+// claims indices until the batch is exhausted
+void ThreadPool::run_batch() {
+  int done{0};
+
+  for (int i{_batch_next++}; i < _batch_count; i = _batch_next++) {
+    _batch_fn(_batch_ctx, i);
+    done++;
+  }
+
+  if (done) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if ((_batch_remaining -= done) == 0)
+      _done_cv.notify_all();
+  }
+}
+
+void ThreadPool::parallel_for(int count, void (*fn)(void*, int), void* ctx) {
+  if (count <= 0)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _batch_fn = fn;
+    _batch_ctx = ctx;
+    _batch_count = count;
+    _batch_next = 0;
+    _batch_remaining = count;
+    _batch_generation++;
+  }
+
+  _work_cv.notify_all();
+  run_batch();
+
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  // no worker may still be inside run_batch when the next batch is set up
+  _done_cv.wait(lock, [this]() {
+    return _batch_remaining == 0 && _batch_workers == 0;
+  });
+
+  _batch_count = 0;
+}
+
+void ThreadPool::worker() {
+  unsigned seen_generation{0};
+
+  while (true) {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    _work_cv.wait(lock, [&]() {
+      return _stop || !_jobs.empty() ||
+        (_batch_generation != seen_generation && _batch_count);
+    });
+
+    if (_batch_generation != seen_generation && _batch_count) {
+      seen_generation = _batch_generation;
+      _batch_workers++;
+      lock.unlock();
+
+      run_batch();
+
+      lock.lock();
+
+      if (--_batch_workers == 0)
+        _done_cv.notify_all();
+
+      continue;
+    }
+
+    if (_jobs.empty()) {
+      if (_stop)
+        return;
+
+      continue;
+    }
+
+    auto job{std::move(_jobs.front())};
+    _jobs.pop_front();
+    _busy++;
+    lock.unlock();
+
+    job();
+
+    lock.lock();
+    _busy--;
+
+    if (_jobs.empty() && _busy == 0)
+      _done_cv.notify_all();
+  }
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <algorithm>
+#include <stdexcept>
 
 #include "tile_map.hpp"
+#include "memory_usage.hpp"
 
 int TileMap::width() const { return _width; }
 int TileMap::height() const { return _height; }
@@ -11,29 +13,58 @@ const std::vector<std::pair<int, int>>& TileMap::modified_tiles() const {
   return _modified_tiles;
 }
 
+bool TileMap::all_modified() const { return _all_modified; }
+
+std::size_t TileMap::memory_bytes() const {
+  return memory_usage::bytes(_data) + memory_usage::bytes(_modified_tiles);
+}
+
+// whole map changes set a flag instead of listing every tile which would
+// cost more than the change itself on large maps
 TileMap::TileMap(int width, int height, int tile_size, int tile) :
-  _width(width), _height(height), _tile_size(tile_size)
+  _width(width), _height(height), _tile_size(tile_size), _all_modified(true)
 {
   std::vector<int> cols(width, tile);
 
-  for (int r{0}; r < _height; r++) {
+  for (int r{0}; r < _height; r++)
     _data.push_back(cols);
 
-    for (int c{0}; c < _width; c++)
-      _modified_tiles.push_back({r, c});
+  _modified_tiles.reserve(max_modified_tiles());
+}
+
+// Past a quarter of the map redrawing everything costs about as much as
+// redrawing each change, so the list is capped there and never grows
+// during a run.
+int TileMap::max_modified_tiles() const {
+  return std::min(_width * _height / 4, 1 << 16);
+}
+
+void TileMap::add_modified_tile(int c, int r) {
+  if (_all_modified)
+    return;
+
+  if ((int)_modified_tiles.size() >= max_modified_tiles()) {
+    _modified_tiles.clear();
+    _all_modified = true;
+
+    return;
   }
+
+  _modified_tiles.push_back({r, c});
 }
 
 void TileMap::clear(int tile) {
-  for (int r{0}; r < _height; r++) {
+  for (int r{0}; r < _height; r++)
     std::fill(_data[r].begin(), _data[r].end(), tile);
 
-    for (int c{0}; c < _width; c++)
-      _modified_tiles.push_back({r, c});
-  }
+  _modified_tiles.clear();
+  _all_modified = true;
 }
 
-void TileMap::reset_modified_tiles() { _modified_tiles.clear(); }
+void TileMap::reset_modified_tiles() {
+  _modified_tiles.clear();
+  _all_modified = false;
+}
 
 bool TileMap::in_bounds(int c, int r) const {
   return c >= 0 && c < _width && r >= 0 && r < _height;
@@ -52,7 +83,22 @@ int TileMap::get_tile(int c, int r) const {
 void TileMap::set_tile(int c, int r, int tile) {
   if (_data.at(r).at(c) != tile) {
     _data[r][c] = tile;
+    add_modified_tile(c, r);
+  }
+}
+
+void TileMap::fill_rect(const sf::IntRect& rect, int tile) {
+  int left{std::max(rect.left, 0)};
+  int right{std::min(rect.left + rect.width, _width)};
+  int bottom{std::min(rect.top + rect.height, _height)};
+
+  for (int r{std::max(rect.top, 0)}; r < bottom; r++) {
+    for (int c{left}; c < right; c++) {
+      if (_data[r][c] == tile)
+        continue;
 
-    _modified_tiles.push_back({r, c});
+      _data[r][c] = tile;
+      add_modified_tile(c, r);
+    }
   }
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <SFML/Graphics/Image.hpp>
+#include <cstring>
+
+#include "tile_raster.hpp"
+
+int TileRaster::tile_px() const { return _tile_px; }
+
+// nearest neighbour scaling matches how the pixel art sprites are drawn
+static void scale_tile(const sf::Image& image, int tile_px,
+  std::uint8_t* out)
+{
+  auto size{image.getSize()};
+  const std::uint8_t* src{image.getPixelsPtr()};
+
+  for (int y{0}; y < tile_px; y++) {
+    int sy(y * size.y / tile_px);
+
+    for (int x{0}; x < tile_px; x++) {
+      int sx(x * size.x / tile_px);
+
+      std::memcpy(out + (y * tile_px + x) * TileRaster::channels,
+        src + (sy * size.x + sx) * TileRaster::channels,
+        TileRaster::channels);
+    }
+  }
+}
+
+bool TileRaster::load(int tile_px, TileType floor_tile) {
+  const int tile_bytes{tile_px * tile_px * channels};
+
+  _tile_px = tile_px;
+  _tiles.assign((int)TileType::end * tile_bytes, 0);
+
+  for (int i{0}; i < (int)TileType::end; i++) {
+    sf::Image image{};
+
+    if (!image.loadFromFile(get_tile_dir((TileType)i)))
+      return false;
+
+    scale_tile(image, tile_px, &_tiles[i * tile_bytes]);
+  }
+
+  // sprites are drawn over the floor so blend them onto it once here
+  const std::uint8_t* floor{&_tiles[(int)floor_tile * tile_bytes]};
+
+  for (int i{0}; i < (int)TileType::end; i++) {
+    std::uint8_t* tile{&_tiles[i * tile_bytes]};
+
+    for (int p{0}; p < tile_bytes; p += channels) {
+      int alpha{tile[p + 3]};
+
+      for (int c{0}; c < 3; c++)
+        tile[p + c] = (tile[p + c] * alpha + floor[p + c] * (255 - alpha)) / 255;
+
+      tile[p + 3] = 255;
+    }
+  }
+
+  // used for cells drawn smaller than a pixel
+  _colours.assign((int)TileType::end * channels, 255);
+
+  for (int i{0}; i < (int)TileType::end; i++) {
+    const std::uint8_t* tile{&_tiles[i * tile_bytes]};
+
+    for (int c{0}; c < 3; c++) {
+      int sum{0};
+
+      for (int p{c}; p < tile_bytes; p += channels)
+        sum += tile[p];
+
+      _colours[i * channels + c] = sum / (tile_px * tile_px);
+    }
+  }
+
+  return true;
+}
+
+void TileRaster::rasterise(const std::uint8_t* cells, int width, int r0,
+  int r1, std::uint8_t* pixels) const
+{
+  const int row_bytes{_tile_px * channels};
+  const int tile_bytes{_tile_px * row_bytes};
+  const int stride{width * row_bytes};
+
+  for (int r{r0}; r < r1; r++) {
+    for (int y{0}; y < _tile_px; y++) {
+      std::uint8_t* out{pixels + (r * _tile_px + y) * stride};
+
+      for (int c{0}; c < width; c++) {
+        std::memcpy(out + c * row_bytes,
+          &_tiles[cells[r * width + c] * tile_bytes + y * row_bytes],
+          row_bytes);
+      }
+    }
+  }
+}
\ No newline at end of file
@@ -1,15 +1,45 @@
 #include <random>
+#include <utility>
 
 #include "util.hpp"
 
 namespace util {
+  rng_t& rng() {
+    thread_local rng_t engine{std::random_device{}()};
+
+    return engine;
+  }
+
+  void seed(std::uint32_t value) { rng().seed(value); }
+
   int rnd_range(int min, int max) { // both inclusive
-    static std::random_device dev{};
-    std::mt19937 rng{dev()};
     std::uniform_int_distribution<int> dist{min, max};
 
-    return dist(rng);
+    return dist(rng());
   }
 
   bool rnd_bool() { return rnd_range(0, 1); };
+
+  std::uint32_t hilbert_index(int side, int x, int y) {
+    std::uint32_t index{0};
+
+    for (int s{side / 2}; s > 0; s /= 2) {
+      int rx{(x & s) > 0};
+      int ry{(y & s) > 0};
+
+      index += (std::uint32_t)s * s * ((3 * rx) ^ ry);
+
+      // turn the quadrant so the curve enters it the same way
+      if (ry == 0) {
+        if (rx == 1) {
+          x = side - 1 - x;
+          y = side - 1 - y;
+        }
+
+        std::swap(x, y);
+      }
+    }
+
+    return index;
+  }
 } 
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include "walk_map.hpp"
+
+int WalkMap::width() const { return _width; }
+int WalkMap::height() const { return _height; }
+int WalkMap::component_count() const { return _component_sizes.size(); }
+int WalkMap::largest_component() const { return _largest_component; }
+
+int WalkMap::component_size(int component) const {
+  return _component_sizes.at(component);
+}
+
+WalkMap::WalkMap(const TileMap& tile_map, int blocked_tile) {
+  build(tile_map, blocked_tile);
+}
+
+void WalkMap::build(const TileMap& tile_map, int blocked_tile) {
+  _width = tile_map.width();
+  _height = tile_map.height();
+  _bits.assign((_width * _height + 63) / 64, 0);
+
+  const auto& data{tile_map.data()};
+
+  for (int r{0}; r < _height; r++) {
+    const auto& row{data[r]};
+    int cell{r * _width};
+
+    for (int c{0}; c < _width; c++, cell++) {
+      if (row[c] != blocked_tile)
+        _bits[cell >> 6] |= std::uint64_t{1} << (cell & 63);
+    }
+  }
+
+  label_components();
+}
+
+// flood fill from each unlabelled walkable cell; the label array doubles as
+// the visited set and the queue is reused across components
+void WalkMap::label_components() {
+  const int cells{_width * _height};
+
+  _labels.assign(cells, no_component);
+  _component_sizes.clear();
+  _largest_component = no_component;
+
+  std::vector<int> queue{};
+  queue.reserve(cells);
+
+  for (int start{0}; start < cells; start++) {
+    if (_labels[start] != no_component || !walkable(start))
+      continue;
+
+    const int label{(int)_component_sizes.size()};
+
+    queue.clear();
+    queue.push_back(start);
+    _labels[start] = label;
+
+    auto visit = [&](int adj) {
+      if (_labels[adj] == no_component && walkable(adj)) {
+        _labels[adj] = label;
+        queue.push_back(adj);
+      }
+    };
+
+    for (std::size_t head{0}; head < queue.size(); head++) {
+      int cell{queue[head]};
+      int c{cell % _width};
+
+      if (c > 0)
+        visit(cell - 1);
+
+      if (c < _width - 1)
+        visit(cell + 1);
+
+      if (cell >= _width)
+        visit(cell - _width);
+
+      if (cell < cells - _width)
+        visit(cell + _width);
+    }
+
+    _component_sizes.push_back(queue.size());
+
+    if (_largest_component == no_component ||
+      (int)queue.size() > _component_sizes[_largest_component])
+    {
+      _largest_component = label;
+    }
+  }
+}
\ No newline at end of file
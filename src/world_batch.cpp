@@ -0,0 +1,579 @@
+#include <algorithm>
+#include <bit>
+
+#include "world_batch.hpp"
+#include "bunny.hpp"
+
+using Rules = rules::Classic;
+using Word = WorldBatch::Word;
+using Cell = WorldBatch::Cell;
+
+// the words of a cell; every one is clear in the worlds where it is empty
+enum Plane : int {
+  occupied,
+  male,
+  infected,
+  stamp, // parity of the turn last updated
+  colour, // two words
+  age = colour + 2, // four words
+  plane_count = age + 4
+};
+
+static_assert(plane_count == WorldBatch::planes);
+
+// the death test below spells out the classic lifespans
+static_assert(Rules::min_lifespan == 10 && Rules::max_lifespan == 12);
+
+static_assert(Rules::min_infected_lifespan == 7 &&
+  Rules::max_infected_lifespan == 10);
+
+static constexpr Word all{~Word{0}};
+static constexpr std::uint64_t golden{0x9e3779b97f4a7c15u};
+
+enum Phase : std::uint64_t {
+  update_phase,
+  infect_phase,
+  birth_phase,
+  newborn_phase,
+  cull_phase,
+  spawn_phase,
+  phases
+};
+
+// splitmix64's finaliser: every input bit flips about half the output bits
+static std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9u;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebu;
+  x ^= x >> 31;
+
+  return x;
+}
+
+static Word pick(Word mask, Word a, Word b) {
+  return (a & mask) | (b & ~mask);
+}
+
+static Word bit_of(int lane) {
+  return Word{1} << lane;
+}
+
+// Random words for one cell and phase, drawn in turn. Each bit is a fair
+// coin of its world.
+class Draws {
+  std::uint64_t _state{};
+
+public:
+  explicit Draws(std::uint64_t key) : _state(mix(key)) {}
+
+  Word next() {
+    _state += golden;
+
+    return mix(_state);
+  }
+
+  // Set in the worlds of mask where a random number of bits bits is below
+  // the world's threshold, whose bit i is in threshold(i). Compared from the
+  // top bit only until every world is settled, so a few worlds take a few
+  // words.
+  template<typename Threshold>
+  Word below(Word mask, int bits, const Threshold& threshold) {
+    Word less{0};
+    Word equal{mask};
+
+    for (int bit{bits - 1}; bit >= 0 && equal; bit--) {
+      const Word r{next()};
+      const Word t{threshold(bit)};
+
+      less |= equal & ~r & t;
+      equal &= ~(r ^ t);
+    }
+
+    return less;
+  }
+
+  // a chance of a third to a byte; the worlds of mask left clear have one
+  // of two thirds
+  Word third(Word mask) {
+    return below(mask, 8, [](int bit) { return 85 >> bit & 1 ? all : 0; });
+  }
+};
+
+// moves the bunnies of src into dst in the worlds of mask
+static void put(Cell& dst, const Cell& src, Word mask) {
+  if (!mask)
+    return;
+
+  for (int p{0}; p < plane_count; p++)
+    dst[p] = pick(mask, src[p], dst[p]);
+}
+
+static void clear(Cell& cell, Word mask) {
+  for (Word& word : cell)
+    word &= ~mask;
+}
+
+// adds a year to every world's age with a carry chain
+static void grow(Cell& cell) {
+  Word carry{all};
+
+  for (int i{0}; i < 4; i++) {
+    const Word next_carry{cell[age + i] & carry};
+
+    cell[age + i] ^= carry;
+    carry = next_carry;
+  }
+}
+
+// Worlds whose bunny dies of age this turn. The lifespan is drawn anew each
+// turn, so a healthy bunny of ten dies with a chance of a third, one of
+// eleven with two thirds and an older one surely; an infected one from
+// seven in quarters. Draws are only made for bunnies old enough.
+static Word dies_of_age(Draws& draws, const Cell& cell, Word live) {
+  const Word* const a{&cell[age]};
+  const Word old{live & (a[3] | (a[2] & a[1] & a[0]))};
+  const Word sick{old & cell[infected]};
+  const Word healthy{old & ~cell[infected]};
+  Word dies{0};
+
+  if (sick) {
+    const Word seven{~a[3] & a[2] & a[1] & a[0]};
+    const Word eight{a[3] & ~a[2] & ~a[1] & ~a[0]};
+    const Word nine{a[3] & ~a[2] & ~a[1] & a[0]};
+    const Word x{draws.next()};
+    const Word y{draws.next()};
+
+    dies |= sick & ((seven & x & y) | (eight & x) | (nine & (x | y)) |
+      (a[3] & (a[2] | a[1])));
+  }
+
+  if (healthy) {
+    const Word ten{a[3] & ~a[2] & a[1] & ~a[0]};
+    const Word eleven{a[3] & ~a[2] & a[1] & a[0]};
+    const Word third{draws.third(healthy & (ten | eleven))};
+
+    dies |= healthy & ((ten & third) | (eleven & ~third) | (a[3] & a[2]));
+  }
+
+  return dies;
+}
+
+// Picks, for the worlds in want, one allowed direction (left, right, up,
+// down) with each alike, as the first allowed in a shuffled order would
+// be. A coin settles left against right and up against down, then each
+// pair wins by its share of the allowed directions.
+static void choose(Draws& draws, Word want, const Word (&allowed)[4],
+  Word (&to)[4])
+{
+  const Word left{allowed[0] & (~allowed[1] | draws.next())};
+  const Word right{allowed[1] & ~left};
+  const Word up{allowed[2] & (~allowed[3] | draws.next())};
+  const Word down{allowed[3] & ~up};
+  const Word both_across{allowed[0] & allowed[1]};
+  const Word both_along{allowed[2] & allowed[3]};
+  const Word uneven{want & (both_across ^ both_along)};
+  Word odds{draws.next()};
+
+  // two directions against one, only drawn where it matters
+  if (uneven)
+    odds = pick(uneven, draws.third(uneven) ^ both_across, odds);
+
+  const Word across{(allowed[0] | allowed[1]) &
+    (~(allowed[2] | allowed[3]) | odds)};
+
+  to[0] = want & across & left;
+  to[1] = want & across & right;
+  to[2] = want & ~across & up;
+  to[3] = want & ~across & down;
+}
+
+void WorldBatch::SlicedCount::add(Word ones) {
+  for (Word& bit : bits) {
+    const Word carry{bit & ones};
+
+    bit ^= ones;
+    ones = carry;
+
+    if (!ones)
+      break;
+  }
+}
+
+std::int64_t WorldBatch::SlicedCount::take(int lane) const {
+  std::int64_t count{0};
+
+  for (int i{0}; i < (int)bits.size(); i++)
+    count |= std::int64_t(bits[i] >> lane & 1) << i;
+
+  return count;
+}
+
+WorldBatch::WorldBatch(int size, std::uint64_t seed,
+  const std::vector<WorldParams>& worlds) :
+    _size(size),
+    _side(size + 2),
+    _worlds(std::min<int>(worlds.size(), lanes)),
+    _seed(seed),
+    _cells(_side * _side),
+    _fresh(_side * _side)
+{
+  // walls read as infected bunnies in every world, so nothing moves, is
+  // born or catches anything there
+  for (int i{0}; i < _side; i++) {
+    for (const int cell : {i, (_side - 1) * _side + i, i * _side,
+      i * _side + _side - 1})
+    {
+      _cells[cell][occupied] = all;
+      _cells[cell][infected] = all;
+    }
+  }
+
+  for (int lane{0}; lane < _worlds; lane++) {
+    const WorldParams& params{worlds[lane]};
+
+    _params[lane] = params;
+
+    // kept to 16 bits, which makes a chance of 1 in 1 one in 2^16 short of
+    // certain, as births only compare that many bits
+    _mutant_thresholds[lane] = params.mutant_chance > 0 ?
+      std::min(0x10000 / params.mutant_chance, 0xffff) : 0;
+
+    for (int bit{0}; bit < 16; bit++) {
+      if (_mutant_thresholds[lane] >> bit & 1)
+        _mutant_bits[bit] |= bit_of(lane);
+    }
+
+    spawn(lane);
+  }
+}
+
+int WorldBatch::worlds() const { return _worlds; }
+int WorldBatch::turn() const { return _turn; }
+
+std::uint64_t WorldBatch::key(std::uint64_t phase) const {
+  return mix(_seed + (std::uint64_t(_turn) * phases + phase) * golden);
+}
+
+int WorldBatch::adjacent(int cell, int dir) const {
+  const int offsets[4]{-1, 1, -_side, _side};
+
+  return cell + offsets[dir];
+}
+
+// spawned bunnies carry this turn's stamp so they are first updated next
+// turn, as with a reset BunnyManager
+void WorldBatch::spawn(int lane) {
+  const WorldParams& params{_params[lane]};
+  const Word bit{bit_of(lane)};
+  const Word now{_turn & 1 ? all : 0};
+  const int amount{std::min(params.initial_spawn, _size * _size)};
+  Draws draws{key(spawn_phase) + lane};
+
+  for (int i{0}; i < amount; i++) {
+    int cell{};
+
+    do {
+      const std::uint64_t r{draws.next()};
+      const int x((r & 0xffffffffu) * _size >> 32);
+      const int y((r >> 32) * _size >> 32);
+
+      cell = (1 + y) * _side + 1 + x;
+    } while (_cells[cell][occupied] & bit);
+
+    const std::uint64_t r{draws.next()};
+    const int colour_value((r & 0xff) * (int)BunnyColour::end >> 8);
+    const int age_value((r >> 8 & 0xff) * (Rules::max_initial_age + 1) >> 8);
+    Cell& here{_cells[cell]};
+
+    here[occupied] |= bit;
+    here[stamp] |= now & bit;
+    here[male] |= r >> 16 & 1 ? bit : 0;
+    here[infected] |= (r >> 32 & 0xffff) < _mutant_thresholds[lane] ? bit : 0;
+
+    for (int i{0}; i < 2; i++)
+      here[colour + i] |= colour_value >> i & 1 ? bit : 0;
+
+    for (int i{0}; i < 4; i++)
+      here[age + i] |= age_value >> i & 1 ? bit : 0;
+  }
+
+  _population[lane] += amount;
+}
+
+// Every bunny not yet updated this turn dies of age, or moves to a free
+// neighbour and grows a year. Bunnies updated carry the turn's stamp, which
+// stops one that moved ahead in the walk being updated twice.
+void WorldBatch::update() {
+  const std::uint64_t pass{key(update_phase)};
+  const Word now{_turn & 1 ? all : 0};
+
+  _has_male = 0;
+
+  for (int y{1}; y <= _size; y++) {
+    for (int x{1}; x <= _size; x++) {
+      const int cell{y * _side + x};
+      Cell& here{_cells[cell]};
+      const Word live{here[occupied] & (here[stamp] ^ now)};
+
+      if (!live)
+        continue;
+
+      Draws draws{pass + cell};
+      Cell* adj[4]{};
+      Word allowed[4]{};
+      Word to[4]{};
+
+      for (int d{0}; d < 4; d++) {
+        adj[d] = &_cells[adjacent(cell, d)];
+        allowed[d] = ~(*adj[d])[occupied];
+      }
+
+      const Word dies{dies_of_age(draws, here, live)};
+
+      choose(draws, live & ~dies, allowed, to);
+
+      const Word moves{to[0] | to[1] | to[2] | to[3]};
+      const Word stays{live & ~dies & ~moves};
+      Cell updated{here};
+
+      grow(updated);
+
+      const Word adult{~here[infected] &
+        (updated[age + 1] | updated[age + 2] | updated[age + 3])};
+
+      updated[stamp] = now;
+
+      _has_male |= (stays | moves) & adult & here[male];
+      _deaths.add(dies);
+
+      for (int d{0}; d < 4; d++)
+        put(*adj[d], updated, to[d]);
+
+      put(here, updated, stays);
+      clear(here, dies | moves);
+    }
+  }
+}
+
+// Each bunny infected before this turn infects the first healthy neighbour
+// in a random order.
+void WorldBatch::infect() {
+  const std::uint64_t pass{key(infect_phase)};
+
+  std::fill(_fresh.begin(), _fresh.end(), 0);
+
+  for (int y{1}; y <= _size; y++) {
+    for (int x{1}; x <= _size; x++) {
+      const int cell{y * _side + x};
+      const Cell& here{_cells[cell]};
+      const Word want{here[infected] & ~_fresh[cell]};
+
+      if (!want)
+        continue;
+
+      Draws draws{pass + cell};
+      Cell* adj[4]{};
+      Word allowed[4]{};
+      Word to[4]{};
+
+      for (int d{0}; d < 4; d++) {
+        adj[d] = &_cells[adjacent(cell, d)];
+        allowed[d] = (*adj[d])[occupied] & ~(*adj[d])[infected];
+      }
+
+      choose(draws, want, allowed, to);
+
+      for (int d{0}; d < 4; d++) {
+        (*adj[d])[infected] |= to[d];
+        _fresh[adjacent(cell, d)] |= to[d];
+      }
+
+      _infections.add(to[0] | to[1] | to[2] | to[3]);
+    }
+  }
+}
+
+// the infection of a newborn's neighbour, a world at a time as few are born
+// infected; keys holds a random byte for each direction
+void WorldBatch::infect_adj(int lane, int cell, std::uint32_t keys) {
+  const Word bit{bit_of(lane)};
+  int chosen{-1};
+  std::uint32_t best{0x100};
+
+  for (int d{0}; d < 4; d++) {
+    const Cell& adj{_cells[adjacent(cell, d)]};
+    const std::uint32_t order{((keys >> (8 * d)) & 0xfc) | d};
+
+    if (adj[occupied] & ~adj[infected] & bit && order < best) {
+      best = order;
+      chosen = d;
+    }
+  }
+
+  if (chosen < 0)
+    return;
+
+  _cells[adjacent(cell, chosen)][infected] |= bit;
+  _fresh[adjacent(cell, chosen)] |= bit;
+  _totals[lane].infections++;
+}
+
+// Each adult female healthy when updated gives birth in the first free
+// neighbour in a random order if a breedable male lived through the
+// update. A newborn takes its mother's colour, and one born infected
+// infects a neighbour straight away.
+void WorldBatch::birth() {
+  const std::uint64_t pass{key(birth_phase)};
+  const std::uint64_t newborn_pass{key(newborn_phase)};
+  const Word now{_turn & 1 ? all : 0};
+
+  for (int y{1}; y <= _size; y++) {
+    for (int x{1}; x <= _size; x++) {
+      const int cell{y * _side + x};
+      const Cell& here{_cells[cell]};
+      const Word* const a{&here[age]};
+
+      // newborns are not yet adults and every other bunny was updated
+      const Word want{here[occupied] & ~here[male] & (a[1] | a[2] | a[3]) &
+        (~here[infected] | _fresh[cell]) & _has_male};
+
+      if (!want)
+        continue;
+
+      Draws draws{pass + cell};
+      Word allowed[4]{};
+      Word to[4]{};
+
+      for (int d{0}; d < 4; d++)
+        allowed[d] = ~_cells[adjacent(cell, d)][occupied];
+
+      choose(draws, want, allowed, to);
+
+      Cell baby{};
+
+      baby[occupied] = all;
+      baby[stamp] = now;
+      baby[male] = draws.next();
+      baby[colour] = here[colour];
+      baby[colour + 1] = here[colour + 1];
+
+      for (int d{0}; d < 4; d++) {
+        const int born_cell{adjacent(cell, d)};
+
+        put(_cells[born_cell], baby, to[d]);
+
+        // born a mutant with each world's chance, compared as a whole word
+        const Word sick{draws.below(to[d], 16,
+          [this](int bit) { return _mutant_bits[bit]; })};
+
+        _cells[born_cell][infected] |= sick;
+
+        for (Word born{sick}; born; born &= born - 1) {
+          const int lane{std::countr_zero(born)};
+
+          infect_adj(lane, born_cell,
+            std::uint32_t(mix(newborn_pass + born_cell * lanes + lane)));
+        }
+      }
+
+      _births.add(to[0] | to[1] | to[2] | to[3]);
+    }
+  }
+}
+
+// Worlds over their limit keep half of it. Selection sampling keeps each
+// bunny with the chance of needed over remaining, which keeps exactly
+// needed and picks every subset of that size alike. Bunnies are visited a
+// world at a time, and only in the worlds culling.
+void WorldBatch::cull() {
+  const std::uint64_t pass{key(cull_phase)};
+
+  LaneArray<std::uint64_t> needed{};
+  LaneArray<std::uint64_t> remaining{};
+  Word culling{0};
+
+  for (int lane{0}; lane < _worlds; lane++) {
+    if (_population[lane] <= _params[lane].bunny_limit)
+      continue;
+
+    needed[lane] = _params[lane].bunny_limit / 2;
+    remaining[lane] = _population[lane];
+    _totals[lane].culls += _population[lane] - needed[lane];
+    _population[lane] = needed[lane];
+    culling |= bit_of(lane);
+  }
+
+  if (!culling)
+    return;
+
+  for (int y{1}; y <= _size; y++) {
+    for (int x{1}; x <= _size; x++) {
+      const int cell{y * _side + x};
+      Cell& here{_cells[cell]};
+
+      for (Word visit{here[occupied] & culling}; visit; visit &= visit - 1) {
+        const int lane{std::countr_zero(visit)};
+        const std::uint64_t r{mix(pass + cell * lanes + lane) >> 32};
+        const std::uint64_t keep{(r * remaining[lane] >> 32) < needed[lane]};
+
+        // without a branch, which would go either way as often
+        clear(here, bit_of(lane) & (keep - 1));
+        needed[lane] -= keep;
+        remaining[lane]--;
+      }
+    }
+  }
+}
+
+void WorldBatch::next_turn() {
+  _turn++;
+
+  update();
+  infect();
+  birth();
+
+  for (int lane{0}; lane < _worlds; lane++) {
+    WorldResult& total{_totals[lane]};
+    const std::int64_t births{_births.take(lane)};
+    const std::int64_t deaths{_deaths.take(lane)};
+
+    total.births += births;
+    total.deaths += deaths;
+    total.infections += _infections.take(lane);
+    _population[lane] += births - deaths;
+  }
+
+  _births = SlicedCount{};
+  _deaths = SlicedCount{};
+  _infections = SlicedCount{};
+
+  cull();
+
+  for (int lane{0}; lane < _worlds; lane++) {
+    if (_population[lane] > 0)
+      continue;
+
+    _totals[lane].extinctions++;
+    spawn(lane);
+  }
+}
+
+std::vector<WorldResult> WorldBatch::results() const {
+  std::vector<WorldResult> results(_totals.begin(),
+    _totals.begin() + _worlds);
+
+  for (int lane{0}; lane < _worlds; lane++)
+    results[lane].population = _population[lane];
+
+  for (int y{1}; y <= _size; y++) {
+    for (int x{1}; x <= _size; x++) {
+      const Cell& here{_cells[y * _side + x]};
+
+      for (Word sick{here[infected]}; sick; sick &= sick - 1)
+        results[std::countr_zero(sick)].infected++;
+    }
+  }
+
+  return results;
+}
\ No newline at end of file